@@ -6,14 +6,44 @@ from api.lifespan import startup, shutdown
 from contextlib import asynccontextmanager
 import option_solver_cpp
 from api.background_tasks import PollingState, start_polling_loop, stop_polling_loop
+from api.pricing_workers import spawn_local_workers, stop_local_workers
 from typing import List
+import os
 
 # Global state
 polling_state = PollingState()
 cache = RedisCache()
-processor = option_solver_cpp.JobQueueProcessor()
+# Cap on the combined grid memory of in-flight pricing jobs (MiB)
+MEMORY_BUDGET_MB = int(os.getenv('PRICER_MEMORY_BUDGET_MB', '2048'))
+
+# Pricing runs in-process by default. PRICER_WORKERS starts that many local worker
+# processes that split the memory budget and the cores between them,
+# PRICER_WORKER_ENDPOINTS (comma separated unix:/tcp: endpoints) uses remote ones.
+NUM_LOCAL_WORKERS = int(os.getenv('PRICER_WORKERS', '0'))
+WORKER_ENDPOINTS = [e for e in os.getenv('PRICER_WORKER_ENDPOINTS', '').split(',') if e]
+worker_processes = []
+if NUM_LOCAL_WORKERS > 0:
+    worker_processes, WORKER_ENDPOINTS = spawn_local_workers(NUM_LOCAL_WORKERS, memory_budget_mb=MEMORY_BUDGET_MB)
+if WORKER_ENDPOINTS:
+    # Jobs of a lost worker move to the others; with none left, batches are priced in-process
+    processor = option_solver_cpp.ShardedJobQueueProcessor(
+        WORKER_ENDPOINTS, fallback_memory_budget_bytes=MEMORY_BUDGET_MB * 1024 * 1024
+    )
+else:
+    processor = option_solver_cpp.JobQueueProcessor(memory_budget_bytes=MEMORY_BUDGET_MB * 1024 * 1024)
 job_queue = option_solver_cpp.JobQueue()
 
+# Optional memory-mapped result store shared with other reader processes
+RESULT_STORE_PATH = os.getenv('PRICER_RESULT_STORE_PATH')
+RESULT_STORE_CAPACITY = int(os.getenv('PRICER_RESULT_STORE_CAPACITY', '65536'))
+result_store = option_solver_cpp.ResultStore(RESULT_STORE_PATH, RESULT_STORE_CAPACITY) if RESULT_STORE_PATH else None
+
+# Publish provisional coarse-grid prices first and refine them (in-process pricing only)
+PROGRESSIVE_TOLERANCE = os.getenv('PRICER_PROGRESSIVE_TOLERANCE')
+
+# Screening-grade float32 solves, re-solved in double when the accuracy check fails
+PRECISION = option_solver_cpp.Precision.FLOAT if os.getenv('PRICER_PRECISION', 'double') == 'float' else option_solver_cpp.Precision.DOUBLE
+
 DEFAULT_STARTING_TICKERS = ['AAPL', 'GOOG', 'CELH', 'MSFT']
 
 def restart_polling_loop():
@@ -27,7 +57,11 @@ def restart_polling_loop():
             updated_tickers, 
             cache.cache_option_job_result,
             processor,
-            job_queue
+            job_queue,
+            result_store=result_store,
+            publish_function=cache.publish_result_store if result_store is not None else None,
+            progressive_tolerance=float(PROGRESSIVE_TOLERANCE) if PROGRESSIVE_TOLERANCE and not WORKER_ENDPOINTS else None,
+            precision=PRECISION
         )
     else:
         print("No tickers to poll.")
@@ -44,6 +78,8 @@ async def lifespan(app: FastAPI):
     # Shutdown logic
     print("Shutting down...")
     stop_polling_loop(polling_state)
+    if worker_processes:
+        stop_local_workers(worker_processes, processor)
     shutdown(cache)
     print("Shutdown complete.")
 
@@ -62,6 +98,8 @@ def add_ticker(request: TickerRequest):
 @app.delete('/delete_ticker')
 def delete_ticker(request: TickerRequest):
     cache.delete_ticker(request.ticker)
+    if result_store is not None:
+        result_store.remove_ticker(request.ticker)
     restart_polling_loop()
     return {"message": f"Ticker {request.ticker} deleted and polling loop restarted"}
 
@@ -71,4 +109,13 @@ def get_cached_tickers():
 
 @app.get('/get_cached_options_for_ticker', response_model=List[OptionResult])
 def get_cached_options_for_ticker(ticker: str):
+    if result_store is not None:
+        return [
+            OptionResult(
+                ticker=r.ticker, option_type=r.option_type, K=r.K, T=r.T,
+                current_price=r.current_price, current_option_price=r.current_option_price,
+                fair_value=r.fair_value
+            )
+            for r in result_store.read_ticker(ticker)
+        ]
     return cache.get_cached_options_for_ticker(ticker)
\ No newline at end of file
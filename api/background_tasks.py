@@ -1,5 +1,5 @@
 import threading
-from typing import List, Callable
+from typing import List, Callable, Optional, Union
 from market_data.options_poller import continuous_poll_and_process
 import option_solver_cpp
 
@@ -12,13 +12,23 @@ def start_polling_loop(
     state: PollingState, 
     tickers: List[str], 
     callback: Callable, 
-    processor: option_solver_cpp.JobQueueProcessor, 
-    job_queue: option_solver_cpp.JobQueue
+    processor: Union[option_solver_cpp.JobQueueProcessor, option_solver_cpp.ShardedJobQueueProcessor], 
+    job_queue: option_solver_cpp.JobQueue,
+    result_store: Optional[option_solver_cpp.ResultStore] = None,
+    publish_function: Optional[Callable] = None,
+    progressive_tolerance: Optional[float] = None,
+    precision: option_solver_cpp.Precision = option_solver_cpp.Precision.DOUBLE
 ):
     state.stop_event.clear()
     state.polling_thread = threading.Thread(
         target=continuous_poll_and_process,
-        args=(tickers, callback, state.stop_event, processor, job_queue)
+        args=(tickers, callback, state.stop_event, processor, job_queue),
+        kwargs={
+            'result_store': result_store,
+            'publish_function': publish_function,
+            'progressive_tolerance': progressive_tolerance,
+            'precision': precision
+        }
     )
     state.polling_thread.start()
 
@@ -10,4 +10,5 @@ class OptionResult(BaseModel):
     T: float
     current_price: float
     current_option_price: float
-    fair_value: float
\ No newline at end of file
+    fair_value: float
+    provisional: bool = False
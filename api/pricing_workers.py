@@ -0,0 +1,65 @@
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+from typing import List, Tuple
+import option_solver_cpp
+
+def spawn_local_workers(
+    num_workers: int,
+    socket_dir: str = None,
+    memory_budget_mb: int = 2048,
+    num_threads: int = None
+) -> Tuple[List[subprocess.Popen], List[str]]:
+    """
+    Start pricing worker processes on this machine, each listening on a Unix socket
+
+    The workers share the machine, so memory_budget_mb and num_threads (default: all cores)
+    are totals that are split evenly between them.
+
+    Returns:
+        (processes, endpoints) where endpoints can be passed to ShardedJobQueueProcessor
+    """
+    socket_dir = socket_dir or tempfile.mkdtemp(prefix='pde_pricer_workers_')
+    repo_root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    worker_budget_mb = max(memory_budget_mb // num_workers, 1)
+    worker_threads = max((num_threads or os.cpu_count() or 1) // num_workers, 1)
+
+    processes = []
+    endpoints = []
+    for i in range(num_workers):
+        endpoint = f'unix:{os.path.join(socket_dir, f"worker-{i}.sock")}'
+        processes.append(subprocess.Popen(
+            [
+                sys.executable, '-m', 'api.pricing_workers', '--endpoint', endpoint,
+                '--memory-budget-mb', str(worker_budget_mb), '--threads', str(worker_threads)
+            ],
+            cwd=repo_root
+        ))
+        endpoints.append(endpoint)
+    return processes, endpoints
+
+def stop_local_workers(processes: List[subprocess.Popen], coordinator: option_solver_cpp.ShardedJobQueueProcessor = None, timeout: float = 5.0):
+    """Ask workers to exit through the coordinator, then make sure the processes are gone."""
+    if coordinator is not None:
+        coordinator.shutdown_workers()
+    for process in processes:
+        try:
+            process.wait(timeout=timeout)
+        except subprocess.TimeoutExpired:
+            process.terminate()
+            process.wait()
+
+def main():
+    parser = argparse.ArgumentParser(description='Run a pricing worker process')
+    parser.add_argument('--endpoint', required=True, help='unix:/path/to/socket or tcp:host:port')
+    parser.add_argument('--memory-budget-mb', type=int, default=2048)
+    parser.add_argument('--threads', type=int, default=0, help='pricing threads, 0 for all cores')
+    args = parser.parse_args()
+
+    worker = option_solver_cpp.PricingWorker(args.endpoint, args.memory_budget_mb * 1024 * 1024, args.threads)
+    worker.serve()
+
+if __name__ == '__main__':
+    main()
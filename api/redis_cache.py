@@ -1,5 +1,5 @@
 import redis
-from option_solver_cpp import OptionJobResult
+from option_solver_cpp import OptionJobResult, ResultStore
 
 class RedisCache:
     def __init__(self, host='redis', port=6379):
@@ -17,25 +17,37 @@ class RedisCache:
         self.redis_client.rpush('active_tickers', *tickers)
 
     def cache_option_job_result(self, option: OptionJobResult):
-        ticker = option.ticker
-        option_key = f'option:{ticker}:{option.option_type}:{option.K}:{option.T}'
-        ticker_set_key = f'options_for:{ticker}'
+        self.cache_option_job_results([option])
 
-        # Use a pipeline for atomic operations
-        with self.redis_client.pipeline() as pipe:
-            pipe.delete(option_key) # clear previous value to ensure freshness
-            pipe.hset(option_key, mapping={
-                'ticker': option.ticker,
-                'option_type': option.option_type,
-                'K': option.K,
-                'T': option.T,
-                'current_price': option.current_price,
-                'current_option_price': option.current_option_price,
-                'fair_value': option.fair_value
-            })
-            pipe.sadd(ticker_set_key, option_key)
+    def cache_option_job_results(self, options: list[OptionJobResult]):
+        """Publish a whole batch of results in a single pipeline round trip."""
+        if not options:
+            return
+
+        with self.redis_client.pipeline(transaction=False) as pipe:
+            for option in options:
+                option_key = f'option:{option.ticker}:{option.option_type}:{option.K}:{option.T}'
+                pipe.delete(option_key)
+                pipe.hset(option_key, mapping={
+                    'ticker': option.ticker,
+                    'option_type': option.option_type,
+                    'K': option.K,
+                    'T': option.T,
+                    'current_price': option.current_price,
+                    'current_option_price': option.current_option_price,
+                    'fair_value': option.fair_value,
+                    'provisional': int(option.provisional)
+                })
+                pipe.sadd(f'options_for:{option.ticker}', option_key)
             pipe.execute()
 
+    def publish_result_store(self, store: ResultStore, tickers: list[str]):
+        """Flush the current contents of a ResultStore to Redis once per batch."""
+        results = []
+        for ticker in tickers:
+            results.extend(store.read_ticker(ticker))
+        self.cache_option_job_results(results)
+
     def delete_ticker(self, ticker: str):
         ticker_set_key = f'options_for:{ticker}'
         option_keys = self.redis_client.smembers(ticker_set_key)
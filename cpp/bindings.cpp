@@ -4,14 +4,17 @@
 #include <pybind11/functional.h>
 #include "models/option.h"
 #include "solvers/crank_nicolson.h"
+#include "solvers/mesh.h"
 #include "job_queue.h"
+#include "result_store.h"
+#include "workers/worker_pool.h"
 
 namespace py = pybind11;
 
 PYBIND11_MODULE(option_solver_cpp, m) {
     m.doc() = "PDE Option Pricer C++ Module";
     
-    m.def("solve_crank_nicolson", &solve_crank_nicolson, "Solve the PDE using the Crank-Nicolson method");
+    m.def("solve_crank_nicolson", &solve_crank_nicolson<double>, "Solve the PDE using the Crank-Nicolson method");
     
     // Expose Option classes
     py::class_<Option>(m, "Option")
@@ -36,11 +39,16 @@ PYBIND11_MODULE(option_solver_cpp, m) {
         .def(py::init<double, double, double, double, double>(),
             py::arg("K"), py::arg("T"), py::arg("r"), py::arg("sigma"), py::arg("q") = 0.0);
 
+    py::enum_<Precision>(m, "Precision")
+        .value("DOUBLE", Precision::DOUBLE)
+        .value("FLOAT", Precision::FLOAT);
+
     // Expose job system
     py::class_<OptionJob>(m, "OptionJob")
-        .def(py::init<std::string, std::string, double, double, double, double, double, double, double>(),
+        .def(py::init<std::string, std::string, double, double, double, double, double, double, double, Precision>(),
             py::arg("ticker"), py::arg("option_type"), py::arg("K"), py::arg("T"),
-            py::arg("current_price"), py::arg("current_option_price"), py::arg("r"), py::arg("sigma"), py::arg("q") = 0.0)
+            py::arg("current_price"), py::arg("current_option_price"), py::arg("r"), py::arg("sigma"), py::arg("q") = 0.0,
+            py::arg("precision") = Precision::DOUBLE)
         .def_property_readonly("ticker", &OptionJob::get_ticker)
         .def_property_readonly("option_type", &OptionJob::get_option_type)
         .def_property_readonly("K", &OptionJob::get_K)
@@ -50,25 +58,83 @@ PYBIND11_MODULE(option_solver_cpp, m) {
         .def_property_readonly("r", &OptionJob::get_r)
         .def_property_readonly("sigma", &OptionJob::get_sigma)
         .def_property_readonly("q", &OptionJob::get_q)
+        .def_property_readonly("precision", &OptionJob::get_precision)
         .def_property_readonly("S_max", &OptionJob::get_S_max)
         .def_property_readonly("J", &OptionJob::get_J)
         .def_property_readonly("N", &OptionJob::get_N);
 
     py::class_<OptionJobResult>(m, "OptionJobResult")
+        .def(py::init<std::string, std::string, double, double, double, double, double, bool>(),
+            py::arg("ticker"), py::arg("option_type"), py::arg("K"), py::arg("T"),
+            py::arg("current_price"), py::arg("current_option_price"), py::arg("fair_value"), py::arg("provisional") = false)
         .def_readonly("ticker", &OptionJobResult::ticker)
         .def_readonly("option_type", &OptionJobResult::option_type)
         .def_readonly("K", &OptionJobResult::K)
         .def_readonly("T", &OptionJobResult::T)
         .def_readonly("current_price", &OptionJobResult::current_price)
         .def_readonly("current_option_price", &OptionJobResult::current_option_price)
-        .def_readonly("fair_value", &OptionJobResult::fair_value);
+        .def_readonly("fair_value", &OptionJobResult::fair_value)
+        .def_readonly("provisional", &OptionJobResult::provisional);
 
     py::class_<JobQueue>(m, "JobQueue")
         .def(py::init<>())
         .def("add_or_replace_job", &JobQueue::add_or_replace_job)
         .def("size", &JobQueue::size);
 
+    py::enum_<SolverMode>(m, "SolverMode")
+        .value("FULL_GRID", SolverMode::FULL_GRID)
+        .value("ROLLING", SolverMode::ROLLING);
+
+    m.attr("FLOAT_PRICE_TOLERANCE") = FLOAT_PRICE_TOLERANCE;
+    m.attr("FLOAT_ERROR_SAFETY_FACTOR") = FLOAT_ERROR_SAFETY_FACTOR;
+
+    m.def("estimate_working_set_bytes", &estimate_working_set_bytes, "Estimate peak bytes for a mesh + solve of size N x J",
+        py::arg("N"), py::arg("J"), py::arg("mode"), py::arg("precision") = Precision::DOUBLE);
+
     py::class_<JobQueueProcessor>(m, "JobQueueProcessor")
-        .def(py::init<>())
-        .def("run_batch", &JobQueueProcessor::run_batch, "Process jobs from queue in parallel and stream results via callback");
+        .def(py::init<size_t, size_t>(), py::arg("memory_budget_bytes") = DEFAULT_MEMORY_BUDGET_BYTES, py::arg("num_threads") = 0)
+        .def_property_readonly("memory_budget_bytes", &JobQueueProcessor::get_memory_budget_bytes)
+        .def_property_readonly("num_threads", &JobQueueProcessor::get_num_threads)
+        .def_static("estimate_job_bytes", &JobQueueProcessor::estimate_job_bytes, py::arg("job"), py::arg("mode") = SolverMode::ROLLING)
+        .def_static("solve_job", &JobQueueProcessor::solve_job, "Price one job on the calling thread with the given mesh layout",
+            py::arg("job"), py::arg("mode"), py::call_guard<py::gil_scoped_release>())
+        .def_static("float_error_estimate", &JobQueueProcessor::float_error_estimate, "Round-off estimate a float solve is screened with",
+            py::arg("job"), py::arg("mode") = SolverMode::ROLLING, py::call_guard<py::gil_scoped_release>())
+        .def_static("float_rounding_floor", &JobQueueProcessor::float_rounding_floor, "Lower bound of float_error_estimate known before solving",
+            py::arg("job"))
+        .def("run_batch", &JobQueueProcessor::run_batch, "Process jobs from queue in parallel and stream results via callback")
+        .def("run_batch_to_store", &JobQueueProcessor::run_batch_to_store, "Process jobs from queue in parallel and write results into a ResultStore")
+        .def("run_batch_progressive", &JobQueueProcessor::run_batch_progressive, "Publish provisional coarse-grid prices first, then refined prices as workers free up",
+            py::arg("queue"), py::arg("callback"), py::arg("tolerance") = DEFAULT_PROGRESSIVE_TOLERANCE);
+
+    py::class_<ResultStore>(m, "ResultStore")
+        .def(py::init<std::string, size_t>(), py::arg("path"), py::arg("capacity") = 0)
+        .def_property_readonly("path", &ResultStore::get_path)
+        .def_property_readonly("capacity", &ResultStore::get_capacity)
+        .def("size", &ResultStore::size)
+        .def("write", &ResultStore::write)
+        .def("begin_batch", &ResultStore::begin_batch)
+        .def("reclaim_stale", py::overload_cast<uint64_t>(&ResultStore::reclaim_stale), py::arg("generation"))
+        .def("reclaim_stale", py::overload_cast<uint64_t, const std::set<std::string>&>(&ResultStore::reclaim_stale),
+            "Only reclaim contracts of the given tickers", py::arg("generation"), py::arg("tickers"))
+        .def("read_ticker", &ResultStore::read_ticker, py::call_guard<py::gil_scoped_release>())
+        .def("read_all", &ResultStore::read_all, py::call_guard<py::gil_scoped_release>())
+        .def("remove_ticker", &ResultStore::remove_ticker);
+
+    // Multi-process pricing
+    py::class_<PricingWorker>(m, "PricingWorker")
+        .def(py::init<std::string, size_t, size_t>(), py::arg("endpoint"), py::arg("memory_budget_bytes") = DEFAULT_MEMORY_BUDGET_BYTES, py::arg("num_threads") = 0)
+        .def_property_readonly("endpoint", &PricingWorker::get_endpoint)
+        .def("serve", &PricingWorker::serve, py::call_guard<py::gil_scoped_release>(), "Serve coordinator connections until shut down");
+
+    py::class_<ShardedJobQueueProcessor>(m, "ShardedJobQueueProcessor")
+        .def(py::init<std::vector<std::string>, int, size_t>(), py::arg("endpoints"), py::arg("connect_timeout_ms") = 5000,
+            py::arg("fallback_memory_budget_bytes") = DEFAULT_MEMORY_BUDGET_BYTES)
+        .def_property_readonly("endpoints", &ShardedJobQueueProcessor::get_endpoints)
+        .def("num_workers", &ShardedJobQueueProcessor::num_workers)
+        .def("num_connected", &ShardedJobQueueProcessor::num_connected)
+        .def("shard_for", &ShardedJobQueueProcessor::shard_for)
+        .def("run_batch", &ShardedJobQueueProcessor::run_batch, "Shard jobs across workers and stream results via callback")
+        .def("run_batch_to_store", &ShardedJobQueueProcessor::run_batch_to_store, "Shard jobs across workers and write results into a ResultStore")
+        .def("shutdown_workers", &ShardedJobQueueProcessor::shutdown_workers);
 }
\ No newline at end of file
@@ -1,13 +1,17 @@
 #include "job_queue.h"
 #include "solvers/mesh.h"
 #include "solvers/crank_nicolson.h"
+#include "result_store.h"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <pybind11/pybind11.h>
 #include <queue>
 #include <mutex>
 #include <vector>
 #include <thread>
 #include <functional>
+#include <limits>
 
 namespace py = pybind11;
 
@@ -22,9 +26,10 @@ OptionJob::OptionJob(
     double current_option_price,
     double r,
     double sigma,
-    double q
+    double q,
+    Precision precision
 ) : ticker(ticker), option_type(option_type), K(K), T(T), 
-    current_price(current_price), current_option_price(current_option_price), r(r), sigma(sigma), q(q) { 
+    current_price(current_price), current_option_price(current_option_price), r(r), sigma(sigma), q(q), precision(precision) { 
     option = create_option();
     S_max = calculate_S_max();
     J = calculate_J();
@@ -60,7 +65,7 @@ int OptionJob::calculate_N() const {
 OptionJob::OptionJob(const OptionJob& other)
     : ticker(other.ticker), option_type(other.option_type), K(other.K), T(other.T),
       current_price(other.current_price), current_option_price(other.current_option_price), 
-      r(other.r), sigma(other.sigma), q(other.q),
+      r(other.r), sigma(other.sigma), q(other.q), precision(other.precision),
       S_max(other.S_max), J(other.J), N(other.N) {
     // Create a new copy of the option
     option = create_option();
@@ -82,6 +87,7 @@ OptionJob& OptionJob::operator=(const OptionJob& other) {
         r = other.r;
         sigma = other.sigma;
         q = other.q;
+        precision = other.precision;
         
         S_max = other.S_max;
         J = other.J;
@@ -147,54 +153,162 @@ OptionJob JobQueue::front() const {
     return job_queue.front();
 }
 
+std::set<std::string> batch_tickers(const std::vector<OptionJob>& jobs) {
+    std::set<std::string> tickers;
+    for (const auto& job : jobs) {
+        tickers.insert(job.get_ticker());
+    }
+    return tickers;
+}
+
 // JobQueueProcessor implementation
-OptionJobResult JobQueueProcessor::run_job_static(const OptionJob& job) {
+size_t JobQueueProcessor::estimate_job_bytes(const OptionJob& job, SolverMode mode) {
+    return estimate_working_set_bytes(job.get_N(), job.get_J(), mode, job.get_precision());
+}
+
+void JobQueueProcessor::acquire_memory(size_t bytes) {
+    std::unique_lock<std::mutex> lock(memory_mutex);
+    // A job larger than the whole budget is admitted alone rather than never
+    memory_available.wait(lock, [this, bytes]() {
+        return memory_in_use == 0 || memory_in_use + bytes <= memory_budget_bytes;
+    });
+    memory_in_use += bytes;
+}
+
+void JobQueueProcessor::release_memory(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(memory_mutex);
+        memory_in_use -= bytes;
+    }
+    memory_available.notify_all();
+}
+
+// Vanilla payoffs are largest at an end of the S grid
+static double largest_payoff(const OptionJob& job) {
+    const Option& option = *job.get_option();
+    return std::max(std::abs(option.payoff(0.0)), std::abs(option.payoff(job.get_S_max())));
+}
+
+// Price job on an N x J grid at precision Real; interpolate linearly in S instead of snapping
+// to the grid point below. If error_estimate is given it receives the round-off estimate
+// compared against FLOAT_PRICE_TOLERANCE, or the largest double if the solve is not finite.
+template <typename Real>
+static double solve_on_grid(const OptionJob& job, int N, int J, SolverMode mode, bool interpolate, double* error_estimate) {
     Option* option = job.get_option();
-    MeshData mesh = initialize_mesh(*option, job.get_S_max(), job.get_N(), job.get_J());
-    double* grid_values = solve_crank_nicolson(
-        *option,
-        job.get_S_max(),
-        job.get_T(),
-        job.get_N(),
-        job.get_J(),
-        mesh.V,
-        mesh.S,
-        mesh.t
-    );
-    
-    double dS = job.get_S_max() / job.get_J();
-    int space_index = std::min((int)(job.get_current_price() / dS), job.get_J());
-    double fair_price = *(grid_values + space_index);
+    double dS = job.get_S_max() / J;
+    double position = job.get_current_price() / dS;
+    int space_index = std::min((int)position, J);
+
+    // Only the t = 0 row is read, which both modes leave at the start of V
+    auto price_from_mesh = [&](const BasicMeshData<Real>& mesh) {
+        const Real* grid_values = mesh.V;
+        if (error_estimate) {
+            double residual = final_step_residual(*option, job.get_S_max(), job.get_T(), N, J,
+                grid_values, grid_values + J + 1, mesh.S, mesh.t, space_index, space_index + 1);
+
+            // Each step also rounds values as large as the biggest one on the grid or in the payoff
+            double largest = largest_payoff(job);
+            bool finite = true;
+            for (int j = 0; j <= J && finite; ++j) {
+                finite = is_finite_value(grid_values[j]);
+                largest = std::max(largest, std::abs(static_cast<double>(grid_values[j])));
+            }
+            double per_step = std::max(residual, largest * std::numeric_limits<Real>::epsilon() / 2);
+            *error_estimate = finite && per_step < std::numeric_limits<double>::max() / N
+                ? N * per_step : std::numeric_limits<double>::max();
+        }
+        if (!interpolate || space_index >= J) {
+            return static_cast<double>(*(grid_values + space_index));
+        }
+        double weight = position - space_index;
+        return (1.0 - weight) * grid_values[space_index] + weight * grid_values[space_index + 1];
+    };
+
+    if (mode == SolverMode::FULL_GRID) {
+        BasicMeshData<Real> mesh = initialize_mesh<Real>(*option, job.get_S_max(), N, J);
+        solve_crank_nicolson(*option, job.get_S_max(), job.get_T(), N, J, mesh.V, mesh.S, mesh.t);
+        return price_from_mesh(mesh);
+    } else {
+        BasicMeshData<Real> mesh = initialize_rolling_mesh<Real>(*option, job.get_S_max(), N, J);
+        solve_crank_nicolson_rolling(*option, job.get_S_max(), job.get_T(), N, J, mesh.V, mesh.S, mesh.t);
+        return price_from_mesh(mesh);
+    }
+}
+
+double JobQueueProcessor::solve_job(const OptionJob& job, SolverMode mode) {
+    if (job.get_precision() == Precision::FLOAT) {
+        return solve_on_grid<float>(job, job.get_N(), job.get_J(), mode, false, nullptr);
+    }
+    return solve_on_grid<double>(job, job.get_N(), job.get_J(), mode, false, nullptr);
+}
+
+// Rounding N float steps make on the scale of the payoff. The round-off estimate of a
+// solve never comes out below it, so it is known before the solve is attempted.
+static double rounding_floor(const OptionJob& job, int N) {
+    return N * largest_payoff(job) * std::numeric_limits<float>::epsilon() / 2;
+}
+
+double JobQueueProcessor::float_rounding_floor(const OptionJob& job) {
+    return rounding_floor(job, job.get_N());
+}
 
-    OptionJobResult result(job.get_ticker(), job.get_option_type(), job.get_K(), job.get_T(), job.get_current_price(), job.get_current_option_price(), fair_price);
+double JobQueueProcessor::float_error_estimate(const OptionJob& job, SolverMode mode) {
+    double error_estimate = 0.0;
+    solve_on_grid<float>(job, job.get_N(), job.get_J(), mode, false, &error_estimate);
+    return error_estimate;
+}
+
+OptionJobResult JobQueueProcessor::make_result(const OptionJob& job, double fair_value, bool provisional) {
+    OptionJobResult result(job.get_ticker(), job.get_option_type(), job.get_K(), job.get_T(), job.get_current_price(), job.get_current_option_price(), fair_value, provisional);
     return result;
 }
 
-void JobQueueProcessor::run_batch(JobQueue& queue, std::function<void(OptionJobResult)> callback) {
-    std::vector<OptionJob> jobs = queue.get_all_jobs();
-    if (jobs.empty()) return;
+double JobQueueProcessor::solve_admitted(const OptionJob& job, int N, int J, bool interpolate) {
+    // A float solve whose rounding floor already fails the guard would only be thrown away
+    if (job.get_precision() == Precision::FLOAT &&
+        rounding_floor(job, N) <= FLOAT_PRICE_TOLERANCE / FLOAT_ERROR_SAFETY_FACTOR) {
+        size_t bytes = estimate_working_set_bytes(N, J, SolverMode::ROLLING, Precision::FLOAT);
 
-    std::queue<OptionJobResult> results_queue;
-    std::mutex results_mutex;
+        acquire_memory(bytes);
+        double error_estimate = 0.0;
+        double price = solve_on_grid<float>(job, N, J, SolverMode::ROLLING, interpolate, &error_estimate);
+        release_memory(bytes);
+
+        // Dividing keeps a non-finite solve (estimated as the largest double) from overflowing
+        if (is_finite_value(price) && error_estimate <= FLOAT_PRICE_TOLERANCE / FLOAT_ERROR_SAFETY_FACTOR) {
+            return price;
+        }
+    }
 
+    size_t bytes = estimate_working_set_bytes(N, J, SolverMode::ROLLING, Precision::DOUBLE);
+
+    acquire_memory(bytes);
+    double price = solve_on_grid<double>(job, N, J, SolverMode::ROLLING, interpolate, nullptr);
+    release_memory(bytes);
+    return price;
+}
+
+void JobQueueProcessor::process_jobs(const std::vector<OptionJob>& jobs, const std::function<void(const OptionJobResult&)>& on_result) {
     std::vector<std::thread> threads;
     size_t actual_threads = std::min(num_threads, jobs.size());
     threads.reserve(actual_threads);
 
-    size_t jobs_per_thread = jobs.size() / actual_threads;
-    size_t remainder = jobs.size() % actual_threads;
-    
-    py::gil_scoped_release release_gil;
+    // Workers pull jobs in order so admission follows queue order
+    size_t next_job = 0;
+    std::mutex next_job_mutex;
 
     for (size_t i = 0; i < actual_threads; ++i) {
-        size_t start = i * jobs_per_thread + std::min(i, remainder);
-        size_t end = start + jobs_per_thread + (i < remainder ? 1 : 0);
-        
-        threads.emplace_back([&jobs, &results_queue, &results_mutex, start, end]() {
-            for (size_t j = start; j < end; ++j) {
-                OptionJobResult result = run_job_static(jobs[j]);
-                std::lock_guard<std::mutex> lock(results_mutex);
-                results_queue.push(result);
+        threads.emplace_back([this, &jobs, &on_result, &next_job, &next_job_mutex]() {
+            while (true) {
+                size_t j;
+                {
+                    std::lock_guard<std::mutex> lock(next_job_mutex);
+                    if (next_job >= jobs.size()) return;
+                    j = next_job++;
+                }
+
+                double fair_price = solve_admitted(jobs[j], jobs[j].get_N(), jobs[j].get_J(), false);
+                on_result(make_result(jobs[j], fair_price));
             }
         });
     }
@@ -202,7 +316,22 @@ void JobQueueProcessor::run_batch(JobQueue& queue, std::function<void(OptionJobR
     for (auto& thread : threads) {
         thread.join();
     }
-    
+}
+
+void JobQueueProcessor::run_batch(JobQueue& queue, std::function<void(OptionJobResult)> callback) {
+    std::vector<OptionJob> jobs = queue.get_all_jobs();
+    if (jobs.empty()) return;
+
+    std::queue<OptionJobResult> results_queue;
+    std::mutex results_mutex;
+
+    py::gil_scoped_release release_gil;
+
+    process_jobs(jobs, [&results_queue, &results_mutex](const OptionJobResult& result) {
+        std::lock_guard<std::mutex> lock(results_mutex);
+        results_queue.push(result);
+    });
+
     py::gil_scoped_acquire acquire_gil;
     
     while (!results_queue.empty()) {
@@ -210,3 +339,159 @@ void JobQueueProcessor::run_batch(JobQueue& queue, std::function<void(OptionJobR
         results_queue.pop();
     }
 }
+
+size_t JobQueueProcessor::run_batch_to_store(JobQueue& queue, ResultStore& store) {
+    std::vector<OptionJob> jobs = queue.get_all_jobs();
+    if (jobs.empty()) return 0;
+
+    std::atomic<size_t> written(0);
+
+    py::gil_scoped_release release_gil;
+
+    uint64_t generation = store.begin_batch();
+    process_jobs(jobs, [&store, &written](const OptionJobResult& result) {
+        if (store.write(result)) {
+            written.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    // A ticker missing from the batch (its fetch failed) keeps its last prices
+    store.reclaim_stale(generation, batch_tickers(jobs));
+
+    return written.load();
+}
+
+void JobQueueProcessor::run_batch_progressive(JobQueue& queue, std::function<void(OptionJobResult)> callback, double tolerance) {
+    std::vector<OptionJob> jobs = queue.get_all_jobs();
+    if (jobs.empty()) return;
+
+    // Scheduling state: coarse solves are always taken before refinements
+    std::mutex schedule_mutex;
+    std::condition_variable schedule_changed;
+    size_t next_coarse = 0;
+    size_t coarse_in_flight = 0;
+    bool cancelled = false;  // set when the callback throws, workers stop taking jobs
+    std::queue<std::pair<size_t, double>> refine_queue;  // (job index, coarse price)
+
+    // Results handed back to the calling thread as they are produced
+    std::mutex results_mutex;
+    std::condition_variable results_ready;
+    std::queue<OptionJobResult> results_queue;
+    size_t workers_running = 0;
+
+    auto publish = [&](const OptionJob& job, double price, bool provisional) {
+        {
+            std::lock_guard<std::mutex> lock(results_mutex);
+            results_queue.push(make_result(job, price, provisional));
+        }
+        results_ready.notify_one();
+    };
+
+    auto worker = [&]() {
+        while (true) {
+            size_t j;
+            bool coarse;
+            double coarse_price = 0.0;
+            {
+                std::unique_lock<std::mutex> lock(schedule_mutex);
+                schedule_changed.wait(lock, [&]() {
+                    return cancelled || next_coarse < jobs.size() || !refine_queue.empty() || coarse_in_flight == 0;
+                });
+                if (cancelled) {
+                    break;
+                } else if (next_coarse < jobs.size()) {
+                    j = next_coarse++;
+                    coarse = true;
+                    ++coarse_in_flight;
+                } else if (!refine_queue.empty()) {
+                    j = refine_queue.front().first;
+                    coarse_price = refine_queue.front().second;
+                    refine_queue.pop();
+                    coarse = false;
+                } else {
+                    break;
+                }
+            }
+
+            const OptionJob& job = jobs[j];
+            int N_fine = std::max(job.get_N() / 2, PROGRESSIVE_MIN_STEPS);
+            int J_fine = std::max(job.get_J() / 2, PROGRESSIVE_MIN_STEPS);
+
+            if (coarse) {
+                int N_coarse = std::max(job.get_N() / PROGRESSIVE_COARSE_FACTOR, PROGRESSIVE_MIN_STEPS);
+                int J_coarse = std::max(job.get_J() / PROGRESSIVE_COARSE_FACTOR, PROGRESSIVE_MIN_STEPS);
+                double price = solve_admitted(job, N_coarse, J_coarse, true);
+                publish(job, price, true);
+
+                std::lock_guard<std::mutex> lock(schedule_mutex);
+                --coarse_in_flight;
+                refine_queue.push(std::make_pair(j, price));
+                schedule_changed.notify_all();
+            } else {
+                double fine_price = solve_admitted(job, N_fine, J_fine, true);
+                if (std::abs(fine_price - coarse_price) < tolerance) {
+                    // Crank-Nicolson is second order in dt and dS, so halving both cuts the error by ~4
+                    publish(job, (4.0 * fine_price - coarse_price) / 3.0, false);
+                } else {
+                    // Interpolated like the extrapolated branch so every final price uses the same estimator
+                    publish(job, solve_admitted(job, job.get_N(), job.get_J(), true), false);
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(results_mutex);
+            --workers_running;
+        }
+        results_ready.notify_one();
+    };
+
+    std::vector<std::thread> threads;
+    size_t actual_threads = std::min(num_threads, jobs.size());
+    threads.reserve(actual_threads);
+    workers_running = actual_threads;
+
+    py::gil_scoped_release release_gil;
+
+    // The callback runs while workers are still going; if it throws, cancel the
+    // remaining work and join the workers before the exception leaves this scope
+    struct JoinWorkers {
+        std::vector<std::thread>& threads;
+        std::function<void()> cancel;
+        ~JoinWorkers() {
+            cancel();
+            for (auto& thread : threads) {
+                if (thread.joinable()) thread.join();
+            }
+        }
+    } join_workers{threads, [&]() {
+        std::lock_guard<std::mutex> lock(schedule_mutex);
+        cancelled = true;
+        schedule_changed.notify_all();
+    }};
+
+    for (size_t i = 0; i < actual_threads; ++i) {
+        threads.emplace_back(worker);
+    }
+
+    // Stream results to Python while the workers keep going
+    while (true) {
+        std::queue<OptionJobResult> ready;
+        bool finished;
+        {
+            std::unique_lock<std::mutex> lock(results_mutex);
+            results_ready.wait(lock, [&]() { return !results_queue.empty() || workers_running == 0; });
+            std::swap(ready, results_queue);
+            finished = workers_running == 0;
+        }
+
+        if (!ready.empty()) {
+            py::gil_scoped_acquire acquire_gil;
+            while (!ready.empty()) {
+                callback(ready.front());
+                ready.pop();
+            }
+        }
+
+        if (finished) break;
+    }
+}
@@ -1,6 +1,7 @@
 #ifndef JOB_QUEUE_H
 #define JOB_QUEUE_H
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <queue>
@@ -10,7 +11,9 @@
 #include <tuple>
 #include <thread>
 #include <functional>
+#include <condition_variable>
 #include "models/option.h"
+#include "solvers/mesh.h"
 
 // Option jobs
 class OptionJob {
@@ -24,7 +27,8 @@ public:
         double current_option_price,
         double r,
         double sigma,
-        double q
+        double q,
+        Precision precision = Precision::DOUBLE
     );
     
     // Copy constructor
@@ -46,6 +50,7 @@ public:
     inline double get_r() const { return r; }
     inline double get_sigma() const { return sigma; }
     inline double get_q() const { return q; }
+    inline Precision get_precision() const { return precision; }
     
     // Getters for computed private members
     inline double get_S_max() const { return S_max; }
@@ -71,6 +76,7 @@ private:
     double r; // r and sigma are calculated from python market
     double sigma;
     double q;
+    Precision precision; // requested solve precision, not part of the job key
     
     // Computed members since they're implementation details
     double S_max;
@@ -93,6 +99,7 @@ struct OptionJobResult {
     double current_price;
     double current_option_price;
     double fair_value; // computed by the PDE solver
+    bool provisional;  // coarse-grid estimate that a later result will replace
 
     OptionJobResult(
         std::string ticker,
@@ -101,8 +108,9 @@ struct OptionJobResult {
         double T,
         double current_price,
         double current_option_price,
-        double fair_value
-    ) : ticker(ticker), option_type(option_type), K(K), T(T), current_price(current_price), current_option_price(current_option_price), fair_value(fair_value) {}
+        double fair_value,
+        bool provisional = false
+    ) : ticker(ticker), option_type(option_type), K(K), T(T), current_price(current_price), current_option_price(current_option_price), fair_value(fair_value), provisional(provisional) {}
 };
 
 class JobQueue {
@@ -119,15 +127,85 @@ public:
     OptionJob front() const;
 };
 
+// Tickers with at least one job in the batch
+std::set<std::string> batch_tickers(const std::vector<OptionJob>& jobs);
+
+// Default cap on the combined working set of all in-flight jobs
+constexpr size_t DEFAULT_MEMORY_BUDGET_BYTES = static_cast<size_t>(2) * 1024 * 1024 * 1024;
+
+// Progressive pricing: coarse grid is N / 4 x J / 4, refinement first tries N / 2 x J / 2
+constexpr int PROGRESSIVE_COARSE_FACTOR = 4;
+constexpr int PROGRESSIVE_MIN_STEPS = 50;
+constexpr double DEFAULT_PROGRESSIVE_TOLERANCE = 0.01;
+
+// Float solves are accepted when FLOAT_ERROR_SAFETY_FACTOR times the round-off estimate stays
+// below this (dollars). The estimate is N times the larger of the final step's residual and the
+// rounding of the largest grid value. Over spots 20-450, moneyness 0.9-1.1, T 1w-0.25y and
+// sigma 0.2-0.5, float error was up to 6.8x the estimate wherever the estimate was under
+// TOLERANCE / 4, so a factor of 8 keeps accepted prices within the tolerance of double.
+// The ratio grows with the estimate (over 100x once it reaches a few cents), so the bound
+// relies on the factor keeping accepted estimates small.
+constexpr double FLOAT_PRICE_TOLERANCE = 0.02;
+constexpr double FLOAT_ERROR_SAFETY_FACTOR = 8.0;
+
+class ResultStore;
+
 class JobQueueProcessor {
 public:
-    JobQueueProcessor() : num_threads(std::thread::hardware_concurrency()) {}
+    // num_threads 0 uses every hardware thread
+    explicit JobQueueProcessor(size_t memory_budget_bytes = DEFAULT_MEMORY_BUDGET_BYTES, size_t num_threads = 0)
+        : num_threads(num_threads > 0 ? num_threads : std::max<size_t>(std::thread::hardware_concurrency(), 1)), memory_budget_bytes(memory_budget_bytes) {}
     void run_batch(JobQueue& queue, std::function<void(OptionJobResult)> callback);
 
+    // Write results straight into a shared result store from the worker threads, then free
+    // the store's contracts this batch did not rewrite. Returns the number of results written;
+    // fewer than the number of jobs means the store was full or a slot was stalled.
+    size_t run_batch_to_store(JobQueue& queue, ResultStore& store);
+
+    // Publish a provisional coarse-grid price for every job first, then refine with idle workers.
+    // Refinement solves on a 2x finer grid; if that moved the price by less than tolerance the
+    // Richardson-extrapolated value is final, otherwise the job is re-solved at full resolution.
+    // All prices are interpolated in S. If the callback throws, outstanding work is cancelled
+    // and the exception is rethrown once the workers have stopped.
+    void run_batch_progressive(JobQueue& queue, std::function<void(OptionJobResult)> callback, double tolerance = DEFAULT_PROGRESSIVE_TOLERANCE);
+
+    // Run jobs on the thread pool without touching the GIL; on_result is called from worker threads
+    void process_jobs(const std::vector<OptionJob>& jobs, const std::function<void(const OptionJobResult&)>& on_result);
+
+    inline size_t get_memory_budget_bytes() const { return memory_budget_bytes; }
+    inline size_t get_num_threads() const { return num_threads; }
+
+    // Batch pricing only reads the t = 0 row, so it always solves on the rolling two-level mesh
+    static size_t estimate_job_bytes(const OptionJob& job, SolverMode mode = SolverMode::ROLLING);
+
+    // Price one job on its full N x J grid in the given layout at the job's precision,
+    // on the calling thread with no admission control and no float fallback
+    static double solve_job(const OptionJob& job, SolverMode mode);
+
+    // Round-off estimate of a float solve of job in the given layout (see FLOAT_PRICE_TOLERANCE)
+    static double float_error_estimate(const OptionJob& job, SolverMode mode = SolverMode::ROLLING);
+
+    // Lower bound of float_error_estimate known before solving: N times the rounding of the
+    // largest payoff on the grid. Float is only attempted when it passes the guard.
+    static double float_rounding_floor(const OptionJob& job);
+
 private:
-    static OptionJobResult run_job_static(const OptionJob& job);
-    
+    static OptionJobResult make_result(const OptionJob& job, double fair_value, bool provisional = false);
+
+    // Admit, solve and release one N x J grid at the job's precision
+    // Float solves that fail the round-off check are re-admitted and re-solved in double
+    double solve_admitted(const OptionJob& job, int N, int J, bool interpolate);
+
+    // Block until bytes fit under the budget (or nothing else is running)
+    void acquire_memory(size_t bytes);
+    void release_memory(size_t bytes);
+
     const size_t num_threads;
+    const size_t memory_budget_bytes;
+
+    size_t memory_in_use = 0;
+    std::mutex memory_mutex;
+    std::condition_variable memory_available;
 };
 
 #endif // JOB_QUEUE_H 
\ No newline at end of file
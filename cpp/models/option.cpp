@@ -1,5 +1,7 @@
 #include "option.h"
 
+// Boundary and obstacle values are computed in double and stored at the mesh precision
+
 // Option base class constructor
 Option::Option(double K_, double T_, double r_, double sigma_, double q_)
     : K(K_), T(T_), r(r_), sigma(sigma_), q(q_) {}
@@ -13,9 +15,18 @@ double EuropeanCall::payoff(double S) const {
     return std::max(S - K, 0.0);
 }
 
-void EuropeanCall::option_price_boundary(double* V_time, const double* S, const double t, int size) const {
+template <typename Real>
+void EuropeanCall::apply_boundary(Real* V_time, const Real* S, const double t, int size) const {
     V_time[0] = 0.0;
-    V_time[size - 1] = S[size - 1] - K * std::exp(-r * (T - t));
+    V_time[size - 1] = static_cast<Real>(S[size - 1] - K * std::exp(-r * (T - t)));
+}
+
+void EuropeanCall::option_price_boundary(double* V_time, const double* S, const double t, int size) const {
+    apply_boundary(V_time, S, t, size);
+}
+
+void EuropeanCall::option_price_boundary(float* V_time, const float* S, const double t, int size) const {
+    apply_boundary(V_time, S, t, size);
 }
 
 // EuropeanPut constructor
@@ -27,11 +38,20 @@ double EuropeanPut::payoff(double S) const {
     return std::max(K - S, 0.0);
 }
 
-void EuropeanPut::option_price_boundary(double* V_time, const double* S, const double t, int size) const {
-    V_time[0] = K * std::exp(-r * (T - t));
+template <typename Real>
+void EuropeanPut::apply_boundary(Real* V_time, const Real* S, const double t, int size) const {
+    V_time[0] = static_cast<Real>(K * std::exp(-r * (T - t)));
     V_time[size - 1] = 0.0;
 }
 
+void EuropeanPut::option_price_boundary(double* V_time, const double* S, const double t, int size) const {
+    apply_boundary(V_time, S, t, size);
+}
+
+void EuropeanPut::option_price_boundary(float* V_time, const float* S, const double t, int size) const {
+    apply_boundary(V_time, S, t, size);
+}
+
 // AmericanCall constructor
 AmericanCall::AmericanCall(double K_, double T_, double r_, double sigma_, double q_)
     : Option(K_, T_, r_, sigma_, q_) {}
@@ -41,23 +61,42 @@ double AmericanCall::payoff(double S) const {
     return std::max(S - K, 0.0);
 }
 
-void AmericanCall::option_price_boundary(double* V_time, const double* S, const double t, int size) const {
+template <typename Real>
+void AmericanCall::apply_boundary(Real* V_time, const Real* S, const double t, int size) const {
     // Lower boundary: option value cannot be negative
     V_time[0] = 0.0;
-    
+
     // Upper boundary: for deep in-the-money, option approaches intrinsic value
-    V_time[size - 1] = std::max(S[size - 1] - K, S[size - 1] - K * std::exp(-r * (T - t)));
+    double S_max = S[size - 1];
+    V_time[size - 1] = static_cast<Real>(std::max(S_max - K, S_max - K * std::exp(-r * (T - t))));
 }
 
-void AmericanCall::early_exercise_condition(double* V_time, const double* S, const double t, int size) const {
+template <typename Real>
+void AmericanCall::apply_early_exercise(Real* V_time, const Real* S, const double t, int size) const {
     // Apply early exercise condition: V >= intrinsic value
     // American call: V >= max(S - K, 0)
     for (int i = 0; i < size; ++i) {
-        double intrinsic_value = payoff(S[i]);
+        Real intrinsic_value = static_cast<Real>(payoff(S[i]));
         V_time[i] = std::max(V_time[i], intrinsic_value);
     }
 }
 
+void AmericanCall::option_price_boundary(double* V_time, const double* S, const double t, int size) const {
+    apply_boundary(V_time, S, t, size);
+}
+
+void AmericanCall::option_price_boundary(float* V_time, const float* S, const double t, int size) const {
+    apply_boundary(V_time, S, t, size);
+}
+
+void AmericanCall::early_exercise_condition(double* V_time, const double* S, const double t, int size) const {
+    apply_early_exercise(V_time, S, t, size);
+}
+
+void AmericanCall::early_exercise_condition(float* V_time, const float* S, const double t, int size) const {
+    apply_early_exercise(V_time, S, t, size);
+}
+
 // AmericanPut constructor
 AmericanPut::AmericanPut(double K_, double T_, double r_, double sigma_, double q_)
     : Option(K_, T_, r_, sigma_, q_) {}
@@ -67,19 +106,38 @@ double AmericanPut::payoff(double S) const {
     return std::max(K - S, 0.0);
 }
 
-void AmericanPut::option_price_boundary(double* V_time, const double* S, const double t, int size) const {
+template <typename Real>
+void AmericanPut::apply_boundary(Real* V_time, const Real* S, const double t, int size) const {
     // Lower boundary: deep in-the-money put approaches intrinsic value
-    V_time[0] = std::max(K - S[0], K * std::exp(-r * (T - t)) - S[0]);
-    
+    double S_min = S[0];
+    V_time[0] = static_cast<Real>(std::max(K - S_min, K * std::exp(-r * (T - t)) - S_min));
+
     // Upper boundary: option value cannot be negative
     V_time[size - 1] = 0.0;
 }
 
-void AmericanPut::early_exercise_condition(double* V_time, const double* S, const double t, int size) const {
+template <typename Real>
+void AmericanPut::apply_early_exercise(Real* V_time, const Real* S, const double t, int size) const {
     // Apply early exercise condition: V >= intrinsic value
     // American put: V >= max(K - S, 0)
     for (int i = 0; i < size; ++i) {
-        double intrinsic_value = payoff(S[i]);
+        Real intrinsic_value = static_cast<Real>(payoff(S[i]));
         V_time[i] = std::max(V_time[i], intrinsic_value);
     }
-}
\ No newline at end of file
+}
+
+void AmericanPut::option_price_boundary(double* V_time, const double* S, const double t, int size) const {
+    apply_boundary(V_time, S, t, size);
+}
+
+void AmericanPut::option_price_boundary(float* V_time, const float* S, const double t, int size) const {
+    apply_boundary(V_time, S, t, size);
+}
+
+void AmericanPut::early_exercise_condition(double* V_time, const double* S, const double t, int size) const {
+    apply_early_exercise(V_time, S, t, size);
+}
+
+void AmericanPut::early_exercise_condition(float* V_time, const float* S, const double t, int size) const {
+    apply_early_exercise(V_time, S, t, size);
+}
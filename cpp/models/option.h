@@ -11,9 +11,11 @@ public:
 
     virtual double payoff(double S) const = 0;
     virtual void option_price_boundary(double* V_time, const double* S, const double t, int size) const = 0;
+    virtual void option_price_boundary(float* V_time, const float* S, const double t, int size) const = 0;
     
     // Early exercise condition for American options (default: no early exercise)
     virtual void early_exercise_condition(double* V_time, const double* S, const double t, int size) const {}
+    virtual void early_exercise_condition(float* V_time, const float* S, const double t, int size) const {}
 
     // Inline getter methods
     inline double getK() const { return K; }
@@ -43,6 +45,11 @@ public:
     
     double payoff(double S) const override;
     void option_price_boundary(double* V_time, const double* S, const double t, int size) const override;
+    void option_price_boundary(float* V_time, const float* S, const double t, int size) const override;
+
+private:
+    template <typename Real>
+    void apply_boundary(Real* V_time, const Real* S, const double t, int size) const;
 };
 
 class EuropeanPut : public Option {
@@ -51,6 +58,11 @@ public:
     
     double payoff(double S) const override;
     void option_price_boundary(double* V_time, const double* S, const double t, int size) const override;
+    void option_price_boundary(float* V_time, const float* S, const double t, int size) const override;
+
+private:
+    template <typename Real>
+    void apply_boundary(Real* V_time, const Real* S, const double t, int size) const;
 };
 
 class AmericanCall : public Option {
@@ -59,7 +71,15 @@ public:
     
     double payoff(double S) const override;
     void option_price_boundary(double* V_time, const double* S, const double t, int size) const override;
+    void option_price_boundary(float* V_time, const float* S, const double t, int size) const override;
     void early_exercise_condition(double* V_time, const double* S, const double t, int size) const override;
+    void early_exercise_condition(float* V_time, const float* S, const double t, int size) const override;
+
+private:
+    template <typename Real>
+    void apply_boundary(Real* V_time, const Real* S, const double t, int size) const;
+    template <typename Real>
+    void apply_early_exercise(Real* V_time, const Real* S, const double t, int size) const;
 };
 
 class AmericanPut : public Option {
@@ -68,7 +88,15 @@ public:
     
     double payoff(double S) const override;
     void option_price_boundary(double* V_time, const double* S, const double t, int size) const override;
+    void option_price_boundary(float* V_time, const float* S, const double t, int size) const override;
     void early_exercise_condition(double* V_time, const double* S, const double t, int size) const override;
+    void early_exercise_condition(float* V_time, const float* S, const double t, int size) const override;
+
+private:
+    template <typename Real>
+    void apply_boundary(Real* V_time, const Real* S, const double t, int size) const;
+    template <typename Real>
+    void apply_early_exercise(Real* V_time, const Real* S, const double t, int size) const;
 };
 
 #endif // OPTION_H 
\ No newline at end of file
@@ -0,0 +1,451 @@
+#include "result_store.h"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Atomics in a shared mapping only synchronize across processes when they are lock-free
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "ResultStore needs lock-free 64-bit atomics");
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "ResultStore needs lock-free 32-bit atomics");
+
+static std::runtime_error system_error(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+
+// Yield until done() holds or the stall timeout passes; returns done()
+template <typename Done>
+static bool wait_until(Done done) {
+    if (done()) {
+        return true;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RESULT_STORE_STALL_TIMEOUT_MS);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+ResultStore::ResultStore(const std::string& path, size_t capacity)
+    : path(path), capacity(capacity), mapped_bytes(0), fd(-1), mapping(nullptr), slots(nullptr) {
+    fd = ::open(path.c_str(), capacity > 0 ? (O_RDWR | O_CREAT) : O_RDWR, 0666);
+    if (fd < 0) {
+        throw system_error("Could not open result store", path);
+    }
+
+    // Serialize initialization between processes racing to create the file
+    ::flock(fd, LOCK_EX);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::flock(fd, LOCK_UN);
+        ::close(fd);
+        throw system_error("Could not stat result store", path);
+    }
+
+    bool initialize = st.st_size == 0;
+    if (initialize) {
+        if (capacity == 0) {
+            ::flock(fd, LOCK_UN);
+            ::close(fd);
+            throw std::invalid_argument("Result store '" + path + "' is empty and no capacity was given");
+        }
+        // ftruncate zero-fills, which leaves every slot SLOT_EMPTY with sequence 0
+        if (::ftruncate(fd, sizeof(ResultStoreHeader) + capacity * sizeof(ResultSlot)) != 0) {
+            ::flock(fd, LOCK_UN);
+            ::close(fd);
+            throw system_error("Could not size result store", path);
+        }
+    } else {
+        ResultStoreHeader header;
+        if (::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            header.magic != RESULT_STORE_MAGIC ||
+            header.layout_version != RESULT_STORE_LAYOUT_VERSION ||
+            header.slot_size != sizeof(ResultSlot)) {
+            ::flock(fd, LOCK_UN);
+            ::close(fd);
+            throw std::invalid_argument("File '" + path + "' is not a compatible result store");
+        }
+        this->capacity = header.capacity;
+    }
+
+    mapped_bytes = sizeof(ResultStoreHeader) + this->capacity * sizeof(ResultSlot);
+    mapping = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        ::flock(fd, LOCK_UN);
+        ::close(fd);
+        throw system_error("Could not map result store", path);
+    }
+
+    ResultStoreHeader* header = static_cast<ResultStoreHeader*>(mapping);
+    if (initialize) {
+        header->capacity = this->capacity;
+        header->slot_size = sizeof(ResultSlot);
+        header->layout_version = RESULT_STORE_LAYOUT_VERSION;
+        header->magic = RESULT_STORE_MAGIC;
+    }
+    slots = reinterpret_cast<ResultSlot*>(static_cast<char*>(mapping) + sizeof(ResultStoreHeader));
+
+    if (!initialize) {
+        recover_abandoned_slots();
+    }
+
+    ::flock(fd, LOCK_UN);
+}
+
+ResultStore::~ResultStore() {
+    if (mapping) {
+        ::munmap(mapping, mapped_bytes);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+uint64_t ResultStore::hash_key(const std::string& ticker, const std::string& option_type, double K, double T) {
+    // FNV-1a, stable across processes and builds
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&h](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            h ^= bytes[i];
+            h *= 1099511628211ULL;
+        }
+    };
+    mix(ticker.data(), ticker.size());
+    mix("\0", 1);
+    mix(option_type.data(), option_type.size());
+    mix(&K, sizeof(K));
+    mix(&T, sizeof(T));
+    return h;
+}
+
+bool ResultStore::key_matches(const ResultSlot& slot, const std::string& ticker, const std::string& option_type, double K, double T) {
+    return slot.K == K && slot.T == T &&
+        std::strncmp(slot.ticker, ticker.c_str(), RESULT_STORE_TICKER_SIZE) == 0 &&
+        std::strncmp(slot.option_type, option_type.c_str(), RESULT_STORE_OPTION_TYPE_SIZE) == 0;
+}
+
+bool ResultStore::lock_slot(ResultSlot& slot, uint64_t& seq) {
+    seq = slot.sequence.load(std::memory_order_relaxed);
+    bool locked = wait_until([&slot, &seq]() {
+        if (seq & 1) {
+            seq = slot.sequence.load(std::memory_order_relaxed);
+            return false;
+        }
+        // On failure seq is reloaded with the current value
+        return slot.sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    });
+    if (locked) {
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    return locked;
+}
+
+void ResultStore::unlock_slot(ResultSlot& slot, uint64_t seq) {
+    slot.sequence.store(seq + 2, std::memory_order_release);
+}
+
+void ResultStore::fill_slot(ResultSlot& slot, const OptionJobResult& result, uint64_t generation) {
+    std::memset(slot.ticker, 0, RESULT_STORE_TICKER_SIZE);
+    std::memset(slot.option_type, 0, RESULT_STORE_OPTION_TYPE_SIZE);
+    std::memcpy(slot.ticker, result.ticker.data(), result.ticker.size());
+    std::memcpy(slot.option_type, result.option_type.data(), result.option_type.size());
+    slot.K = result.K;
+    slot.T = result.T;
+    slot.current_price = result.current_price;
+    slot.current_option_price = result.current_option_price;
+    slot.fair_value = result.fair_value;
+    slot.generation = generation;
+    slot.valid = 1;
+}
+
+void ResultStore::free_slot(ResultSlot& slot) {
+    slot.valid = 0;
+    std::memset(slot.ticker, 0, RESULT_STORE_TICKER_SIZE);
+    std::memset(slot.option_type, 0, RESULT_STORE_OPTION_TYPE_SIZE);
+    slot.state.store(SLOT_FREE, std::memory_order_release);
+}
+
+static bool process_is_dead(int32_t pid) {
+    return ::kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH;
+}
+
+bool ResultStore::lock_inserts() {
+    std::atomic<int32_t>& owner = header()->insert_owner;
+    int32_t self = static_cast<int32_t>(::getpid());
+    if (wait_until([&owner, self]() {
+            int32_t expected = 0;
+            return owner.compare_exchange_weak(expected, self, std::memory_order_acquire, std::memory_order_relaxed);
+        })) {
+        return true;
+    }
+    // Held past the stall timeout: take it over only if the holder has died
+    int32_t holder = owner.load(std::memory_order_relaxed);
+    return holder != 0 && process_is_dead(holder) &&
+        owner.compare_exchange_strong(holder, self, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void ResultStore::unlock_inserts() {
+    header()->insert_owner.store(0, std::memory_order_release);
+}
+
+void ResultStore::recover_abandoned_slots() {
+    int32_t holder = header()->insert_owner.load(std::memory_order_acquire);
+    if (holder != 0 && process_is_dead(holder)) {
+        header()->insert_owner.compare_exchange_strong(holder, 0, std::memory_order_acq_rel);
+    }
+
+    std::vector<std::pair<size_t, uint64_t>> suspects;
+    for (size_t i = 0; i < capacity; ++i) {
+        uint64_t seq = slots[i].sequence.load(std::memory_order_acquire);
+        if (seq & 1) {
+            suspects.emplace_back(i, seq);
+        }
+    }
+    if (suspects.empty()) {
+        return;
+    }
+
+    // Give writers that are still alive the stall timeout to finish
+    std::this_thread::sleep_for(std::chrono::milliseconds(RESULT_STORE_STALL_TIMEOUT_MS));
+
+    for (const auto& suspect : suspects) {
+        ResultSlot& slot = slots[suspect.first];
+        if (slot.sequence.load(std::memory_order_acquire) != suspect.second) {
+            continue;
+        }
+        // The dead writer's lock is inherited as is. The payload may be torn,
+        // so the contract is dropped rather than kept.
+        free_slot(slot);
+        unlock_slot(slot, suspect.second - 1);
+    }
+}
+
+bool ResultStore::read_slot(const ResultSlot& slot, std::vector<OptionJobResult>& out, const std::string* ticker) const {
+    if (slot.state.load(std::memory_order_acquire) != SLOT_OCCUPIED) {
+        return false;
+    }
+
+    uint32_t valid;
+    char slot_ticker[RESULT_STORE_TICKER_SIZE];
+    char slot_option_type[RESULT_STORE_OPTION_TYPE_SIZE];
+    double K;
+    double T;
+    double current_price;
+    double current_option_price;
+    double fair_value;
+    bool consistent = wait_until([&]() {
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        valid = slot.valid;
+        std::memcpy(slot_ticker, slot.ticker, RESULT_STORE_TICKER_SIZE);
+        std::memcpy(slot_option_type, slot.option_type, RESULT_STORE_OPTION_TYPE_SIZE);
+        K = slot.K;
+        T = slot.T;
+        current_price = slot.current_price;
+        current_option_price = slot.current_option_price;
+        fair_value = slot.fair_value;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    });
+    if (!consistent || !valid) {
+        return false;
+    }
+    if (ticker && std::strncmp(slot_ticker, ticker->c_str(), RESULT_STORE_TICKER_SIZE) != 0) {
+        return false;
+    }
+
+    out.emplace_back(
+        std::string(slot_ticker, strnlen(slot_ticker, RESULT_STORE_TICKER_SIZE)),
+        std::string(slot_option_type, strnlen(slot_option_type, RESULT_STORE_OPTION_TYPE_SIZE)),
+        K, T, current_price, current_option_price, fair_value
+    );
+    return true;
+}
+
+ResultStore::Probe ResultStore::update_existing(const OptionJobResult& result, uint64_t generation, size_t& target) {
+    size_t start = hash_key(result.ticker, result.option_type, result.K, result.T) % capacity;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RESULT_STORE_STALL_TIMEOUT_MS);
+
+    // Restarted when the matching slot is freed under us
+    while (std::chrono::steady_clock::now() < deadline) {
+        size_t index = start;
+        size_t probes = 0;
+        size_t reusable = capacity;  // first SLOT_FREE on the probe sequence
+        bool restart = false;
+
+        while (probes < capacity) {
+            ResultSlot& slot = slots[index];
+            uint32_t state = slot.state.load(std::memory_order_acquire);
+
+            if (state == SLOT_EMPTY) {
+                break;
+            }
+            if (state == SLOT_FREE) {
+                if (reusable == capacity) {
+                    reusable = index;
+                }
+            } else if (key_matches(slot, result.ticker, result.option_type, result.K, result.T)) {
+                // Recheck under the lock, the slot may have been freed since
+                uint64_t seq;
+                if (!lock_slot(slot, seq)) {
+                    return Probe::STALLED;
+                }
+                bool still_ours = slot.state.load(std::memory_order_acquire) == SLOT_OCCUPIED &&
+                    key_matches(slot, result.ticker, result.option_type, result.K, result.T);
+                if (still_ours) {
+                    fill_slot(slot, result, generation);
+                }
+                unlock_slot(slot, seq);
+                if (still_ours) {
+                    return Probe::UPDATED;
+                }
+                restart = true;
+                break;
+            }
+
+            index = (index + 1) % capacity;
+            ++probes;
+        }
+        if (restart) {
+            continue;
+        }
+
+        // Not present: a new key reuses the first free slot, else the empty one that ended the probe
+        target = reusable < capacity ? reusable : (probes < capacity ? index : capacity);
+        return Probe::ABSENT;
+    }
+    return Probe::STALLED;
+}
+
+bool ResultStore::write(const OptionJobResult& result) {
+    if (result.ticker.size() > RESULT_STORE_TICKER_SIZE || result.option_type.size() > RESULT_STORE_OPTION_TYPE_SIZE) {
+        return false;
+    }
+
+    uint64_t generation = header()->generation.load(std::memory_order_acquire);
+    size_t target = capacity;
+    Probe probe = update_existing(result, generation, target);
+    if (probe != Probe::ABSENT) {
+        return probe == Probe::UPDATED;
+    }
+
+    // Only the insert lock holder turns FREE or EMPTY slots OCCUPIED, so the
+    // probe repeated under it cannot race another insert of the same key
+    if (!lock_inserts()) {
+        return false;
+    }
+    probe = update_existing(result, generation, target);
+    bool written = probe == Probe::UPDATED;
+    if (probe == Probe::ABSENT && target < capacity) {
+        ResultSlot& slot = slots[target];
+        uint64_t seq;
+        if (lock_slot(slot, seq)) {
+            fill_slot(slot, result, generation);
+            slot.state.store(SLOT_OCCUPIED, std::memory_order_release);
+            unlock_slot(slot, seq);
+            written = true;
+        }
+    }
+    unlock_inserts();
+    return written;
+}
+
+uint64_t ResultStore::begin_batch() {
+    return header()->generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+template <typename TickerFilter>
+size_t ResultStore::reclaim_stale_if(uint64_t generation, TickerFilter in_batch) {
+    size_t reclaimed = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        ResultSlot& slot = slots[i];
+        if (slot.state.load(std::memory_order_acquire) != SLOT_OCCUPIED || slot.generation >= generation) {
+            continue;
+        }
+        uint64_t seq;
+        if (!lock_slot(slot, seq)) {
+            continue;
+        }
+        if (slot.state.load(std::memory_order_acquire) == SLOT_OCCUPIED && slot.generation < generation &&
+            in_batch(slot.ticker)) {
+            free_slot(slot);
+            ++reclaimed;
+        }
+        unlock_slot(slot, seq);
+    }
+    return reclaimed;
+}
+
+size_t ResultStore::reclaim_stale(uint64_t generation) {
+    return reclaim_stale_if(generation, [](const char*) { return true; });
+}
+
+size_t ResultStore::reclaim_stale(uint64_t generation, const std::set<std::string>& tickers) {
+    return reclaim_stale_if(generation, [&tickers](const char* ticker) {
+        return tickers.count(std::string(ticker, strnlen(ticker, RESULT_STORE_TICKER_SIZE))) > 0;
+    });
+}
+
+std::vector<OptionJobResult> ResultStore::read_ticker(const std::string& ticker) const {
+    std::vector<OptionJobResult> results;
+    if (ticker.size() > RESULT_STORE_TICKER_SIZE) {
+        return results;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+        read_slot(slots[i], results, &ticker);
+    }
+    return results;
+}
+
+std::vector<OptionJobResult> ResultStore::read_all() const {
+    std::vector<OptionJobResult> results;
+    for (size_t i = 0; i < capacity; ++i) {
+        read_slot(slots[i], results);
+    }
+    return results;
+}
+
+void ResultStore::remove_ticker(const std::string& ticker) {
+    if (ticker.size() > RESULT_STORE_TICKER_SIZE) {
+        return;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+        ResultSlot& slot = slots[i];
+        if (slot.state.load(std::memory_order_acquire) != SLOT_OCCUPIED ||
+            std::strncmp(slot.ticker, ticker.c_str(), RESULT_STORE_TICKER_SIZE) != 0) {
+            continue;
+        }
+        uint64_t seq;
+        if (!lock_slot(slot, seq)) {
+            continue;
+        }
+        if (slot.state.load(std::memory_order_acquire) == SLOT_OCCUPIED &&
+            std::strncmp(slot.ticker, ticker.c_str(), RESULT_STORE_TICKER_SIZE) == 0) {
+            free_slot(slot);
+        }
+        unlock_slot(slot, seq);
+    }
+}
+
+size_t ResultStore::size() const {
+    size_t count = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        if (slots[i].state.load(std::memory_order_acquire) == SLOT_OCCUPIED) {
+            ++count;
+        }
+    }
+    return count;
+}
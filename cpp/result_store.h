@@ -0,0 +1,139 @@
+#ifndef RESULT_STORE_H
+#define RESULT_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+#include "job_queue.h"
+
+// Fixed-size fields so the table has the same layout in every process
+constexpr size_t RESULT_STORE_TICKER_SIZE = 16;
+constexpr size_t RESULT_STORE_OPTION_TYPE_SIZE = 16;
+constexpr uint64_t RESULT_STORE_MAGIC = 0x5044455052494345ULL; // "PDEPRICE"
+constexpr uint32_t RESULT_STORE_LAYOUT_VERSION = 3;
+
+// A seqlock or insert lock held longer than this is treated as abandoned by a dead writer
+constexpr int RESULT_STORE_STALL_TIMEOUT_MS = 100;
+
+enum ResultSlotState : uint32_t {
+    SLOT_EMPTY = 0,     // never used, ends a probe sequence
+    SLOT_OCCUPIED = 1,
+    SLOT_FREE = 2       // removed or reclaimed; reusable, but probing continues past it
+};
+
+// File header, followed by capacity ResultSlots
+struct alignas(64) ResultStoreHeader {
+    uint64_t magic;
+    uint32_t layout_version;
+    uint32_t slot_size;
+    uint64_t capacity;
+    std::atomic<uint64_t> generation;  // current batch, see begin_batch
+    std::atomic<int32_t> insert_owner;  // pid of the process inserting a new key, 0 if none
+};
+
+// One contract. Key and payload are guarded by a seqlock: sequence is odd
+// while a writer is updating the slot, readers retry on change.
+struct alignas(64) ResultSlot {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint32_t> state;
+    uint32_t valid;  // 0 once the ticker has been removed
+    char ticker[RESULT_STORE_TICKER_SIZE];
+    char option_type[RESULT_STORE_OPTION_TYPE_SIZE];
+    double K;
+    double T;
+    double current_price;
+    double current_option_price;
+    double fair_value;
+    uint64_t generation;  // batch that last wrote this contract
+};
+
+// Memory-mapped result table keyed by (ticker, option_type, K, T)
+// Open addressing with linear probing. Removed tickers and contracts a batch
+// did not rewrite are freed for reuse, so the table needs room for about two
+// batches when contracts turn over (T is recomputed every day).
+class ResultStore {
+public:
+    // Create the file at path with the given capacity, or open an existing
+    // one (capacity 0 opens an existing file with whatever capacity it has).
+    // Opening an existing file frees slots left locked by a writer that died.
+    // Processes sharing a file must share a pid namespace, see lock_inserts.
+    explicit ResultStore(const std::string& path, size_t capacity = 0);
+    ~ResultStore();
+
+    ResultStore(const ResultStore&) = delete;
+    ResultStore& operator=(const ResultStore&) = delete;
+
+    // Insert or overwrite a contract. Safe to call from any thread or process:
+    // existing contracts are updated in place, new keys are inserted one at a
+    // time so a contract never ends up in two slots.
+    // Returns false if the key does not fit the fixed layout, the table is full
+    // or the slot is held by a stalled writer.
+    bool write(const OptionJobResult& result);
+
+    // Start a new batch; later writes are stamped with the returned generation
+    uint64_t begin_batch();
+
+    // Free every contract not written since the given batch began, optionally
+    // only those of the given tickers. Call once the batch's writes are done.
+    // Returns the number of slots freed.
+    size_t reclaim_stale(uint64_t generation);
+    size_t reclaim_stale(uint64_t generation, const std::set<std::string>& tickers);
+
+    // Consistent snapshots of the current values; slots held by a stalled writer are skipped
+    std::vector<OptionJobResult> read_ticker(const std::string& ticker) const;
+    std::vector<OptionJobResult> read_all() const;
+
+    // Mark every contract of a ticker as invalid
+    void remove_ticker(const std::string& ticker);
+
+    inline const std::string& get_path() const { return path; }
+    inline size_t get_capacity() const { return capacity; }
+    size_t size() const;
+
+private:
+    std::string path;
+    size_t capacity;
+    size_t mapped_bytes;
+    int fd;
+    void* mapping;
+    ResultSlot* slots;
+
+    static uint64_t hash_key(const std::string& ticker, const std::string& option_type, double K, double T);
+    static bool key_matches(const ResultSlot& slot, const std::string& ticker, const std::string& option_type, double K, double T);
+
+    inline ResultStoreHeader* header() const { return static_cast<ResultStoreHeader*>(mapping); }
+
+    enum class Probe { UPDATED, ABSENT, STALLED };
+
+    // Overwrite the contract if it is in the table. When ABSENT, target is the
+    // slot a new key would take, or capacity if the table is full.
+    Probe update_existing(const OptionJobResult& result, uint64_t generation, size_t& target);
+
+    // Exclusive right to insert new keys, held by pid; taken over from an owner that died
+    bool lock_inserts();
+    void unlock_inserts();
+
+    // Free OCCUPIED slots older than generation whose ticker satisfies in_batch
+    template <typename TickerFilter>
+    size_t reclaim_stale_if(uint64_t generation, TickerFilter in_batch);
+
+    // Append a copy of a slot taken under the seqlock; false if the slot holds no valid
+    // result (of the given ticker, if any) or its writer stalled
+    bool read_slot(const ResultSlot& slot, std::vector<OptionJobResult>& out, const std::string* ticker = nullptr) const;
+
+    // Take a slot's seqlock (sequence even -> odd); false if it stays held past the stall timeout
+    static bool lock_slot(ResultSlot& slot, uint64_t& seq);
+    static void unlock_slot(ResultSlot& slot, uint64_t seq);
+
+    // With the seqlock held: store the payload, or clear the slot and mark it SLOT_FREE
+    static void fill_slot(ResultSlot& slot, const OptionJobResult& result, uint64_t generation);
+    static void free_slot(ResultSlot& slot);
+
+    // Free slots left with an odd sequence, and release the insert lock, of a writer that died
+    void recover_abandoned_slots();
+};
+
+#endif // RESULT_STORE_H
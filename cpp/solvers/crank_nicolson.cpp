@@ -1,44 +1,72 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
+#include "crank_nicolson.h"
 #include "../models/option.h"
 
-std::vector<double> tridiagonal_thomas(
-    const std::vector<double>& lower,
-    const std::vector<double>& main,
-    const std::vector<double>& upper,
-    const std::vector<double>& rhs
-) {
-    size_t size = main.size();
-    std::vector<double> x(size, 0.0);
-    std::vector<double> y(size, 0.0);
-    std::vector<double> ans(size, 0.0);
-
-    x[0] = upper[0] / main[0];
-    y[0] = rhs[0] / main[0];
-
+// Forward elimination of the Thomas algorithm: the modified upper diagonal and the pivots
+template <typename Real>
+static void thomas_factor(const Real* lower, const Real* main, const Real* upper, Real* upper_prime, Real* pivot, size_t size) {
+    pivot[0] = main[0];
+    upper_prime[0] = upper[0] / pivot[0];
     for (size_t i = 1; i < size; ++i) {
-        double denom = main[i] - lower[i] * x[i - 1];
-        x[i] = upper[i] / denom;
-        y[i] = (rhs[i] - lower[i] * y[i - 1]) / denom;
+        pivot[i] = main[i] - lower[i] * upper_prime[i - 1];
+        upper_prime[i] = upper[i] / pivot[i];
     }
+}
 
-    ans[size - 1] = y[size - 1];
-
-    for (int i = size - 2; i >= 0; --i) {
-        ans[i] = y[i] - x[i] * ans[i + 1];
+// Solve with a matrix factored by thomas_factor, writing the solution to x (must not alias rhs)
+template <typename Real>
+static void thomas_substitute(const Real* lower, const Real* upper_prime, const Real* pivot, const Real* rhs, Real* x, size_t size) {
+    x[0] = rhs[0] / pivot[0];
+    for (size_t i = 1; i < size; ++i) {
+        x[i] = (rhs[i] - lower[i] * x[i - 1]) / pivot[i];
+    }
+    for (size_t i = size - 1; i-- > 0;) {
+        x[i] = x[i] - upper_prime[i] * x[i + 1];
     }
+}
 
+template <typename Real>
+std::vector<Real> tridiagonal_thomas(
+    const std::vector<Real>& lower,
+    const std::vector<Real>& main,
+    const std::vector<Real>& upper,
+    const std::vector<Real>& rhs
+) {
+    size_t size = main.size();
+    std::vector<Real> upper_prime(size);
+    std::vector<Real> pivot(size);
+    std::vector<Real> ans(size);
+    thomas_factor(lower.data(), main.data(), upper.data(), upper_prime.data(), pivot.data(), size);
+    thomas_substitute(lower.data(), upper_prime.data(), pivot.data(), rhs.data(), ans.data(), size);
     return ans;
 }
 
-double* solve_crank_nicolson(
+// Coefficients of ML and MR, shared by every time step
+// Computed in double and rounded once to the solve precision. ML is also factored
+// once, so a step only substitutes and allocates nothing.
+template <typename Real>
+struct CrankNicolsonMatrices {
+    std::vector<Real> ML_lower;
+    std::vector<Real> ML_main;
+    std::vector<Real> ML_upper;
+    std::vector<Real> MR_lower;
+    std::vector<Real> MR_main;
+    std::vector<Real> MR_upper;
+    std::vector<Real> rhs;
+    std::vector<Real> ML_upper_prime;
+    std::vector<Real> ML_pivot;
+};
+
+template <typename Real>
+static CrankNicolsonMatrices<Real> build_matrices(
     const Option& option,
     const double S_max,
     const double T,
     const int N,
-    const int J,
-    double* V,
-    const double* S,
-    const double* t
+    const int J
 ) {
     const double sigma = option.getSigma();
     const double r = option.getR();
@@ -48,14 +76,17 @@ double* solve_crank_nicolson(
     std::vector<double> a(J - 1);
     std::vector<double> b(J - 1);
     std::vector<double> c(J - 1);
-    std::vector<double> ML_lower(J - 1);
-    std::vector<double> ML_main(J - 1);
-    std::vector<double> ML_upper(J - 1);
-    std::vector<double> MR_lower(J - 1);
-    std::vector<double> MR_main(J - 1);
-    std::vector<double> MR_upper(J - 1);
-    std::vector<double> rhs(J - 1);
-    std::vector<double> thomas_vector(J - 1);
+
+    CrankNicolsonMatrices<Real> m;
+    m.ML_lower.resize(J - 1);
+    m.ML_main.resize(J - 1);
+    m.ML_upper.resize(J - 1);
+    m.MR_lower.resize(J - 1);
+    m.MR_main.resize(J - 1);
+    m.MR_upper.resize(J - 1);
+    m.rhs.resize(J - 1);
+    m.ML_upper_prime.resize(J - 1);
+    m.ML_pivot.resize(J - 1);
 
     double sq_sigma = sigma * sigma;
     double sq_S = 0.0;
@@ -66,40 +97,132 @@ double* solve_crank_nicolson(
         b[j - 1] = -sq_sigma * sq_S * dt_over_sq_dS - r * dt;
         c[j - 1] = 0.5 * sq_sigma * sq_S * dt_over_sq_dS + 0.5 * r * j * dt;
 
-        ML_lower[j - 1] = -0.5 * a[j - 1];
-        ML_main[j - 1] = 1 - 0.5 * b[j - 1];
-        ML_upper[j - 1] = -0.5 * c[j - 1];
+        m.ML_lower[j - 1] = -0.5 * a[j - 1];
+        m.ML_main[j - 1] = 1 - 0.5 * b[j - 1];
+        m.ML_upper[j - 1] = -0.5 * c[j - 1];
 
-        MR_lower[j - 1] = 0.5 * a[j - 1];
-        MR_main[j - 1] = 1 + 0.5 * b[j - 1];
-        MR_upper[j - 1] = 0.5 * c[j - 1];
+        m.MR_lower[j - 1] = 0.5 * a[j - 1];
+        m.MR_main[j - 1] = 1 + 0.5 * b[j - 1];
+        m.MR_upper[j - 1] = 0.5 * c[j - 1];
 
-        rhs[j - 1] = 0.0;
+        m.rhs[j - 1] = 0.0;
     }
+    thomas_factor(m.ML_lower.data(), m.ML_main.data(), m.ML_upper.data(), m.ML_upper_prime.data(), m.ML_pivot.data(), J - 1);
+
+    return m;
+}
+
+// Step backward from time level n + 1 (V_next) to time level n (V_curr)
+template <typename Real>
+static void crank_nicolson_step(
+    const Option& option,
+    CrankNicolsonMatrices<Real>& m,
+    const int J,
+    Real* V_curr,
+    const Real* V_next,
+    const Real* S,
+    const double t_n
+) {
+    option.option_price_boundary(V_curr, S, t_n, J + 1);
+
+    for (int j = 0; j < J - 1; j++) {
+        m.rhs[j] =
+            m.MR_lower[j] * V_next[j] +
+            m.MR_main[j] * V_next[j + 1] +
+            m.MR_upper[j] * V_next[j + 2];
+    }
+
+    m.rhs[0] -= m.ML_lower[0] * V_curr[0];
+    m.rhs[J - 2] -= m.ML_upper[J - 2] * V_curr[J];
+
+    thomas_substitute(m.ML_lower.data(), m.ML_upper_prime.data(), m.ML_pivot.data(), m.rhs.data(), V_curr + 1, J - 1);
+
+    // Apply early exercise condition for American options after solving for the time step
+    option.early_exercise_condition(V_curr, S, t_n, J + 1);
+}
+
+template <typename Real>
+Real* solve_crank_nicolson(
+    const Option& option,
+    const double S_max,
+    const double T,
+    const int N,
+    const int J,
+    Real* V,
+    const Real* S,
+    const Real* t
+) {
+    CrankNicolsonMatrices<Real> m = build_matrices<Real>(option, S_max, T, N, J);
 
     for (int n = N - 1; n > -1; n--) {
-        option.option_price_boundary(V + n * (J + 1), S, t[n], J + 1);
-        
-        for (int j = 0; j < J - 1; j++) {
-            rhs[j] =
-                MR_lower[j] * *(V + (n + 1) * (J + 1) + j) +
-                MR_main[j] * *(V + (n + 1) * (J + 1) + j + 1) +
-                MR_upper[j] * *(V + (n + 1) * (J + 1) + j + 2);
-        }
+        crank_nicolson_step(option, m, J, V + n * (J + 1), V + (n + 1) * (J + 1), S, t[n]);
+    }
 
-        rhs[0] -= ML_lower[0] * *(V + n * (J + 1));
-        rhs[J - 2] -= ML_upper[J - 2] * *(V + n * (J + 1) + J);
+    option.option_price_boundary(V, S, t[0], J + 1);
 
-        thomas_vector = tridiagonal_thomas(ML_lower, ML_main, ML_upper, rhs);
-        for (int j = 1; j < J; j++) {
-            *(V + n * (J + 1) + j) = thomas_vector[j - 1];
-        }
+    return V;
+}
 
-        // Apply early exercise condition for American options after solving for the time step
-        option.early_exercise_condition(V + n * (J + 1), S, t[n], J + 1);
+template <typename Real>
+Real* solve_crank_nicolson_rolling(
+    const Option& option,
+    const double S_max,
+    const double T,
+    const int N,
+    const int J,
+    Real* V,
+    const Real* S,
+    const Real* t
+) {
+    CrankNicolsonMatrices<Real> m = build_matrices<Real>(option, S_max, T, N, J);
+
+    // Time level n is stored in row n % 2, so level 0 ends up in row 0
+    for (int n = N - 1; n > -1; n--) {
+        crank_nicolson_step(option, m, J, V + (n % 2) * (J + 1), V + ((n + 1) % 2) * (J + 1), S, t[n]);
     }
 
     option.option_price_boundary(V, S, t[0], J + 1);
 
     return V;
-}
\ No newline at end of file
+}
+
+template <typename Real>
+double final_step_residual(
+    const Option& option,
+    const double S_max,
+    const double T,
+    const int N,
+    const int J,
+    const Real* V_0,
+    const Real* V_1,
+    const Real* S,
+    const Real* t,
+    const int j_begin,
+    const int j_end
+) {
+    CrankNicolsonMatrices<double> m = build_matrices<double>(option, S_max, T, N, J);
+
+    std::vector<double> V_curr(J + 1, 0.0);
+    std::vector<double> V_next(V_1, V_1 + J + 1);
+    std::vector<double> S_double(S, S + J + 1);
+    crank_nicolson_step(option, m, J, V_curr.data(), V_next.data(), S_double.data(), static_cast<double>(t[0]));
+
+    double residual = 0.0;
+    for (int j = std::max(j_begin, 0); j <= std::min(j_end, J); ++j) {
+        // A NaN anywhere in V_1 spreads through the tridiagonal solve into every V_curr[j]
+        if (!is_finite_value(V_curr[j]) || !is_finite_value(V_0[j])) {
+            return std::numeric_limits<double>::max();
+        }
+        residual = std::max(residual, std::abs(V_curr[j] - static_cast<double>(V_0[j])));
+    }
+    return residual;
+}
+
+template std::vector<double> tridiagonal_thomas<double>(const std::vector<double>&, const std::vector<double>&, const std::vector<double>&, const std::vector<double>&);
+template std::vector<float> tridiagonal_thomas<float>(const std::vector<float>&, const std::vector<float>&, const std::vector<float>&, const std::vector<float>&);
+template double* solve_crank_nicolson<double>(const Option&, const double, const double, const int, const int, double*, const double*, const double*);
+template float* solve_crank_nicolson<float>(const Option&, const double, const double, const int, const int, float*, const float*, const float*);
+template double* solve_crank_nicolson_rolling<double>(const Option&, const double, const double, const int, const int, double*, const double*, const double*);
+template float* solve_crank_nicolson_rolling<float>(const Option&, const double, const double, const int, const int, float*, const float*, const float*);
+template double final_step_residual<double>(const Option&, const double, const double, const int, const int, const double*, const double*, const double*, const double*, const int, const int);
+template double final_step_residual<float>(const Option&, const double, const double, const int, const int, const float*, const float*, const float*, const float*, const int, const int);
@@ -1,27 +1,74 @@
 #ifndef CRANK_NICOLSON_H
 #define CRANK_NICOLSON_H
 
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include "../models/option.h"
 
+// setup.py builds with -ffast-math, under which std::isfinite folds to true and
+// NaN vanishes from std::max, so non-finite values are detected from the exponent bits
+inline bool is_finite_value(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x7FF0000000000000ULL) != 0x7FF0000000000000ULL;
+}
+
+// Solvers are templated on the mesh precision and instantiated for double and float in crank_nicolson.cpp
+
 // Tridiagonal solver using Thomas algorithm
-std::vector<double> tridiagonal_thomas(
-    const std::vector<double>& lower,
-    const std::vector<double>& main,
-    const std::vector<double>& upper,
-    const std::vector<double>& rhs
+template <typename Real>
+std::vector<Real> tridiagonal_thomas(
+    const std::vector<Real>& lower,
+    const std::vector<Real>& main,
+    const std::vector<Real>& upper,
+    const std::vector<Real>& rhs
 );
 
 // Main Crank-Nicolson PDE solver
-double* solve_crank_nicolson(
+template <typename Real>
+Real* solve_crank_nicolson(
+    const Option& option,
+    const double S_max,
+    const double T,
+    const int N,
+    const int J,
+    Real* V,
+    const Real* S,
+    const Real* t
+);
+
+// Crank-Nicolson solver on a two-level mesh from initialize_rolling_mesh
+// Produces the same t = 0 row as solve_crank_nicolson in O(J) memory
+template <typename Real>
+Real* solve_crank_nicolson_rolling(
+    const Option& option,
+    const double S_max,
+    const double T,
+    const int N,
+    const int J,
+    Real* V,
+    const Real* S,
+    const Real* t
+);
+
+// Accuracy check for reduced-precision solves: redo the last step (t[1] -> t[0]) in double
+// from the solver's own t[1] row and return the largest deviation from its t = 0 row over
+// [j_begin, j_end]. Both solver layouts keep t = 0 at V_0 = V and t[1] at V_1 = V + J + 1.
+// Returns the largest finite double if either row is non-finite in that range.
+template <typename Real>
+double final_step_residual(
     const Option& option,
     const double S_max,
     const double T,
     const int N,
     const int J,
-    double* V,
-    const double* S,
-    const double* t
+    const Real* V_0,
+    const Real* V_1,
+    const Real* S,
+    const Real* t,
+    const int j_begin,
+    const int j_end
 );
 
 #endif // CRANK_NICOLSON_H 
\ No newline at end of file
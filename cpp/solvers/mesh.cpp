@@ -1,7 +1,8 @@
 #include "mesh.h"
 #include <cstring>  // for memset
 
-MeshData initialize_mesh(
+template <typename Real>
+BasicMeshData<Real> initialize_mesh(
     const Option& option,
     double S_max,
     int N,
@@ -9,12 +10,12 @@ MeshData initialize_mesh(
 ) {
     // Allocate memory for arrays
     int V_size = (N + 1) * (J + 1);
-    double* V = new double[V_size];
-    double* S = new double[J + 1];
-    double* t = new double[N + 1];
+    Real* V = new Real[V_size];
+    Real* S = new Real[J + 1];
+    Real* t = new Real[N + 1];
     
     // Initialize V to zeros
-    memset(V, 0, V_size * sizeof(double));
+    memset(V, 0, V_size * sizeof(Real));
     
     // Create space grid S: linspace(0, S_max, J + 1)
     for (int j = 0; j <= J; ++j) {
@@ -35,5 +36,53 @@ MeshData initialize_mesh(
     }
     
     // Return MeshData struct
-    return MeshData(V, S, t);
-} 
\ No newline at end of file
+    return BasicMeshData<Real>(V, S, t);
+} 
+template <typename Real>
+BasicMeshData<Real> initialize_rolling_mesh(
+    const Option& option,
+    double S_max,
+    int N,
+    int J
+) {
+    // Only two time levels are stored, row n lives at (n % 2) * (J + 1)
+    int V_size = 2 * (J + 1);
+    Real* V = new Real[V_size];
+    Real* S = new Real[J + 1];
+    Real* t = new Real[N + 1];
+
+    memset(V, 0, V_size * sizeof(Real));
+
+    for (int j = 0; j <= J; ++j) {
+        S[j] = (static_cast<double>(j) / J) * S_max;
+    }
+
+    double T = option.getT();
+    for (int n = 0; n <= N; ++n) {
+        t[n] = (static_cast<double>(n) / N) * T;
+    }
+
+    // Terminal payoff goes in the row for time level N
+    Real* V_terminal = V + (N % 2) * (J + 1);
+    for (int j = 0; j <= J; ++j) {
+        V_terminal[j] = option.payoff(S[j]);
+    }
+
+    return BasicMeshData<Real>(V, S, t);
+}
+
+template BasicMeshData<double> initialize_mesh<double>(const Option&, double, int, int);
+template BasicMeshData<float> initialize_mesh<float>(const Option&, double, int, int);
+template BasicMeshData<double> initialize_rolling_mesh<double>(const Option&, double, int, int);
+template BasicMeshData<float> initialize_rolling_mesh<float>(const Option&, double, int, int);
+
+size_t estimate_working_set_bytes(int N, int J, SolverMode mode, Precision precision) {
+    size_t rows = (mode == SolverMode::FULL_GRID) ? static_cast<size_t>(N) + 1 : 2;
+    size_t mesh_values = rows * (J + 1) + (J + 1) + (N + 1);
+
+    // Crank-Nicolson scratch: 11 coefficient/rhs vectors of size J - 1, including the factored ML
+    size_t solver_values = 11 * static_cast<size_t>(J - 1);
+
+    size_t value_size = (precision == Precision::FLOAT) ? sizeof(float) : sizeof(double);
+    return (mesh_values + solver_values) * value_size;
+}
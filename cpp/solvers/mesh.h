@@ -1,32 +1,67 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <cstddef>
 #include "../models/option.h"
 
+// Storage layout for the value grid
+//   FULL_GRID: all (N + 1) time levels are kept, V[n * (J + 1) + j]
+//   ROLLING:   only two time levels are kept, the solve alternates between them
+enum class SolverMode {
+    FULL_GRID,
+    ROLLING
+};
+
+// Scalar type of the mesh and the Crank-Nicolson time march
+//   DOUBLE: reference precision
+//   FLOAT:  half the memory traffic, guarded by a residual check that falls back to DOUBLE
+enum class Precision {
+    DOUBLE,
+    FLOAT
+};
+
 // Mesh data structure to match Python return
-struct MeshData {
-    double* V;    // 2D value grid (flattened)  
-    double* S;    // Space axis
-    double* t;    // Time axis
+template <typename Real>
+struct BasicMeshData {
+    Real* V;    // 2D value grid (flattened)  
+    Real* S;    // Space axis
+    Real* t;    // Time axis
     
     // Constructor
-    MeshData(double* V_, double* S_, double* t_) 
+    BasicMeshData(Real* V_, Real* S_, Real* t_) 
         : V(V_), S(S_), t(t_) {}
     
     // Destructor to clean up memory
-    ~MeshData() {
+    ~BasicMeshData() {
         delete[] V;
         delete[] S; 
         delete[] t;
     }
 };
 
+using MeshData = BasicMeshData<double>;
+
 // Initialize mesh for PDE solving
-MeshData initialize_mesh(
+// Instantiated for double and float in mesh.cpp
+template <typename Real = double>
+BasicMeshData<Real> initialize_mesh(
+    const Option& option,
+    double S_max,
+    int N,
+    int J
+);
+
+// Initialize a two-level mesh for the rolling solver
+// V holds 2 * (J + 1) values with the terminal payoff in row N % 2
+template <typename Real = double>
+BasicMeshData<Real> initialize_rolling_mesh(
     const Option& option,
     double S_max,
     int N,
     int J
 );
 
+// Estimated peak bytes allocated by one mesh + solve for the given mode and precision
+size_t estimate_working_set_bytes(int N, int J, SolverMode mode, Precision precision = Precision::DOUBLE);
+
 #endif // MESH_H 
\ No newline at end of file
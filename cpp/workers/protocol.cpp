@@ -0,0 +1,294 @@
+#include "protocol.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const size_t FRAME_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t);
+
+// WireWriter implementation
+
+void WireWriter::write_u32(uint32_t value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WireWriter::write_double(double value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WireWriter::write_string(const std::string& value) {
+    if (value.size() > UINT16_MAX) {
+        throw std::invalid_argument("String too long for wire protocol");
+    }
+    uint16_t size = static_cast<uint16_t>(value.size());
+    buffer.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    buffer.append(value);
+}
+
+void WireWriter::write_job(const OptionJob& job) {
+    // S_max, J and N are recomputed by the receiving OptionJob constructor
+    write_string(job.get_ticker());
+    write_string(job.get_option_type());
+    write_double(job.get_K());
+    write_double(job.get_T());
+    write_double(job.get_current_price());
+    write_double(job.get_current_option_price());
+    write_double(job.get_r());
+    write_double(job.get_sigma());
+    write_double(job.get_q());
+    write_u32(static_cast<uint32_t>(job.get_precision()));
+}
+
+void WireWriter::write_result(const OptionJobResult& result) {
+    write_string(result.ticker);
+    write_string(result.option_type);
+    write_double(result.K);
+    write_double(result.T);
+    write_double(result.current_price);
+    write_double(result.current_option_price);
+    write_double(result.fair_value);
+}
+
+// WireReader implementation
+
+void WireReader::read_bytes(void* out, size_t size) {
+    if (static_cast<size_t>(end - cursor) < size) {
+        throw std::runtime_error("Truncated frame payload");
+    }
+    std::memcpy(out, cursor, size);
+    cursor += size;
+}
+
+uint32_t WireReader::read_u32() {
+    uint32_t value;
+    read_bytes(&value, sizeof(value));
+    return value;
+}
+
+double WireReader::read_double() {
+    double value;
+    read_bytes(&value, sizeof(value));
+    return value;
+}
+
+std::string WireReader::read_string() {
+    uint16_t size;
+    read_bytes(&size, sizeof(size));
+    std::string value(size, '\0');
+    read_bytes(&value[0], size);
+    return value;
+}
+
+OptionJob WireReader::read_job() {
+    std::string ticker = read_string();
+    std::string option_type = read_string();
+    double K = read_double();
+    double T = read_double();
+    double current_price = read_double();
+    double current_option_price = read_double();
+    double r = read_double();
+    double sigma = read_double();
+    double q = read_double();
+    Precision precision = static_cast<Precision>(read_u32());
+    return OptionJob(ticker, option_type, K, T, current_price, current_option_price, r, sigma, q, precision);
+}
+
+OptionJobResult WireReader::read_result() {
+    std::string ticker = read_string();
+    std::string option_type = read_string();
+    double K = read_double();
+    double T = read_double();
+    double current_price = read_double();
+    double current_option_price = read_double();
+    double fair_value = read_double();
+    return OptionJobResult(ticker, option_type, K, T, current_price, current_option_price, fair_value);
+}
+
+// FrameReader implementation
+
+bool FrameReader::fill() {
+    char chunk[64 * 1024];
+    while (true) {
+        ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (received > 0) {
+            buffer.append(chunk, received);
+            return true;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        return false;
+    }
+}
+
+bool FrameReader::next_frame(FrameType& type, std::string& payload) {
+    if (buffer.size() < FRAME_HEADER_SIZE) {
+        return false;
+    }
+    uint32_t size;
+    std::memcpy(&size, buffer.data(), sizeof(size));
+    if (buffer.size() < FRAME_HEADER_SIZE + size) {
+        return false;
+    }
+    type = static_cast<FrameType>(static_cast<uint8_t>(buffer[sizeof(uint32_t)]));
+    payload.assign(buffer, FRAME_HEADER_SIZE, size);
+    buffer.erase(0, FRAME_HEADER_SIZE + size);
+    return true;
+}
+
+bool FrameReader::read_frame(FrameType& type, std::string& payload) {
+    while (!next_frame(type, payload)) {
+        if (!fill()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void send_frame(int fd, FrameType type, const std::string& payload) {
+    std::string frame;
+    frame.reserve(FRAME_HEADER_SIZE + payload.size());
+    uint32_t size = static_cast<uint32_t>(payload.size());
+    frame.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    frame.push_back(static_cast<char>(type));
+    frame.append(payload);
+
+    const char* cursor = frame.data();
+    size_t remaining = frame.size();
+    while (remaining > 0) {
+        ssize_t sent = ::send(fd, cursor, remaining, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Failed to send frame: ") + std::strerror(errno));
+        }
+        cursor += sent;
+        remaining -= sent;
+    }
+}
+
+// Endpoint helpers
+
+static void split_tcp_endpoint(const std::string& address, std::string& host, std::string& port) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        throw std::invalid_argument("TCP endpoint must be tcp:host:port, got tcp:" + address);
+    }
+    host = address.substr(0, colon);
+    port = address.substr(colon + 1);
+}
+
+static sockaddr_un unix_address(const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("Unix socket path too long: " + path);
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+int listen_endpoint(const std::string& endpoint) {
+    int fd = -1;
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        std::string path = endpoint.substr(5);
+        sockaddr_un addr = unix_address(path);
+        ::unlink(path.c_str());  // clear a stale socket from a previous run
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            if (fd >= 0) ::close(fd);
+            throw std::runtime_error("Could not bind " + endpoint + ": " + std::strerror(errno));
+        }
+    } else if (endpoint.compare(0, 4, "tcp:") == 0) {
+        std::string host, port;
+        split_tcp_endpoint(endpoint.substr(4), host, port);
+
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* info = nullptr;
+        if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &info) != 0 || !info) {
+            throw std::runtime_error("Could not resolve " + endpoint);
+        }
+        fd = ::socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        int reuse = 1;
+        if (fd >= 0) {
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        }
+        if (fd < 0 || ::bind(fd, info->ai_addr, info->ai_addrlen) != 0) {
+            if (fd >= 0) ::close(fd);
+            ::freeaddrinfo(info);
+            throw std::runtime_error("Could not bind " + endpoint + ": " + std::strerror(errno));
+        }
+        ::freeaddrinfo(info);
+    } else {
+        throw std::invalid_argument("Unknown endpoint scheme: " + endpoint);
+    }
+
+    if (::listen(fd, 8) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not listen on " + endpoint + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+static int try_connect(const std::string& endpoint) {
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        sockaddr_un addr = unix_address(endpoint.substr(5));
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            return fd;
+        }
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    if (endpoint.compare(0, 4, "tcp:") == 0) {
+        std::string host, port;
+        split_tcp_endpoint(endpoint.substr(4), host, port);
+
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* info = nullptr;
+        if (::getaddrinfo(host.c_str(), port.c_str(), &hints, &info) != 0 || !info) {
+            return -1;
+        }
+        int fd = ::socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd >= 0 && ::connect(fd, info->ai_addr, info->ai_addrlen) == 0) {
+            // Results are small frames, don't let Nagle hold them back
+            int no_delay = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+            ::freeaddrinfo(info);
+            return fd;
+        }
+        if (fd >= 0) ::close(fd);
+        ::freeaddrinfo(info);
+        return -1;
+    }
+    throw std::invalid_argument("Unknown endpoint scheme: " + endpoint);
+}
+
+int connect_endpoint(const std::string& endpoint, int timeout_ms) {
+    // Workers may still be starting up, so retry until the timeout
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        int fd = try_connect(endpoint);
+        if (fd >= 0) {
+            return fd;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            throw std::runtime_error("Could not connect to worker at " + endpoint);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
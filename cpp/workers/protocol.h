@@ -0,0 +1,83 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../job_queue.h"
+
+// Wire protocol between the coordinator and pricing workers
+// Every frame is: uint32 payload length | uint8 frame type | payload
+// Integers and doubles are sent in host byte order, so all peers must share an architecture.
+enum class FrameType : uint8_t {
+    JOB_BATCH = 1,   // coordinator -> worker: uint32 count, then count jobs
+    RESULT = 2,      // worker -> coordinator: one result
+    BATCH_DONE = 3,  // worker -> coordinator: uint32 number of results sent
+    SHUTDOWN = 4,    // coordinator -> worker: stop serving
+    ERROR = 5        // worker -> coordinator: error message, batch is aborted
+};
+
+// Payload builder
+class WireWriter {
+public:
+    void write_u32(uint32_t value);
+    void write_double(double value);
+    void write_string(const std::string& value);  // uint16 length + bytes
+
+    void write_job(const OptionJob& job);
+    void write_result(const OptionJobResult& result);
+
+    inline const std::string& data() const { return buffer; }
+    inline void clear() { buffer.clear(); }
+
+private:
+    std::string buffer;
+};
+
+// Payload parser, throws std::runtime_error on truncated input
+class WireReader {
+public:
+    WireReader(const char* data, size_t size) : cursor(data), end(data + size) {}
+    explicit WireReader(const std::string& payload) : WireReader(payload.data(), payload.size()) {}
+
+    uint32_t read_u32();
+    double read_double();
+    std::string read_string();
+
+    OptionJob read_job();
+    OptionJobResult read_result();
+
+private:
+    const char* cursor;
+    const char* end;
+
+    void read_bytes(void* out, size_t size);
+};
+
+// Buffers a socket's byte stream and splits it into frames
+class FrameReader {
+public:
+    explicit FrameReader(int fd) : fd(fd) {}
+
+    // Pull whatever is available from the socket, false on EOF or error
+    bool fill();
+
+    // Pop the next complete frame if one is buffered
+    bool next_frame(FrameType& type, std::string& payload);
+
+    // Block until a full frame arrives, false on EOF or error
+    bool read_frame(FrameType& type, std::string& payload);
+
+private:
+    int fd;
+    std::string buffer;
+};
+
+// Write one frame, throws std::runtime_error on failure
+void send_frame(int fd, FrameType type, const std::string& payload);
+
+// Endpoints are "unix:/path/to/socket" or "tcp:host:port"
+int listen_endpoint(const std::string& endpoint);
+int connect_endpoint(const std::string& endpoint, int timeout_ms);
+
+#endif // PROTOCOL_H
@@ -0,0 +1,408 @@
+#include "worker_pool.h"
+#include "../result_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pybind11/pybind11.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace py = pybind11;
+
+// PricingWorker implementation
+
+PricingWorker::PricingWorker(std::string endpoint, size_t memory_budget_bytes, size_t num_threads)
+    : endpoint(endpoint), processor(memory_budget_bytes, num_threads), listen_fd(-1) {
+    listen_fd = listen_endpoint(this->endpoint);
+}
+
+PricingWorker::~PricingWorker() {
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+    }
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        ::unlink(endpoint.substr(5).c_str());
+    }
+}
+
+void PricingWorker::serve() {
+    while (true) {
+        int connection_fd = ::accept(listen_fd, nullptr, nullptr);
+        if (connection_fd < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Worker accept failed: ") + std::strerror(errno));
+        }
+        // Fails harmlessly on Unix sockets
+        int no_delay = 1;
+        ::setsockopt(connection_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+        bool shutdown = handle_connection(connection_fd);
+        ::close(connection_fd);
+        if (shutdown) {
+            return;
+        }
+    }
+}
+
+bool PricingWorker::handle_connection(int connection_fd) {
+    FrameReader reader(connection_fd);
+    FrameType type;
+    std::string payload;
+
+    while (reader.read_frame(type, payload)) {
+        if (type == FrameType::SHUTDOWN) {
+            return true;
+        }
+        if (type != FrameType::JOB_BATCH) {
+            continue;
+        }
+
+        std::vector<OptionJob> jobs;
+        try {
+            WireReader wire(payload);
+            uint32_t count = wire.read_u32();
+            jobs.reserve(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                jobs.push_back(wire.read_job());
+            }
+        } catch (const std::exception& e) {
+            WireWriter error;
+            error.write_string(e.what());
+            try {
+                send_frame(connection_fd, FrameType::ERROR, error.data());
+            } catch (const std::runtime_error&) {
+                return false;
+            }
+            continue;
+        }
+
+        std::mutex send_mutex;
+        uint32_t sent = 0;
+        bool connection_lost = false;
+
+        processor.process_jobs(jobs, [&](const OptionJobResult& result) {
+            WireWriter frame;
+            frame.write_result(result);
+            std::lock_guard<std::mutex> lock(send_mutex);
+            if (connection_lost) return;
+            try {
+                send_frame(connection_fd, FrameType::RESULT, frame.data());
+                ++sent;
+            } catch (const std::runtime_error&) {
+                connection_lost = true;
+            }
+        });
+
+        if (connection_lost) {
+            return false;
+        }
+
+        // A coordinator that went away only ends this connection, not the worker
+        WireWriter done;
+        done.write_u32(sent);
+        try {
+            send_frame(connection_fd, FrameType::BATCH_DONE, done.data());
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// ShardedJobQueueProcessor implementation
+
+typedef std::tuple<std::string, std::string, double, double> ContractKey;
+
+static size_t shard_hash(const OptionJob& job) {
+    size_t h = std::hash<std::string>()(job.get_ticker());
+    h ^= std::hash<double>()(job.get_T()) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+ShardedJobQueueProcessor::ShardedJobQueueProcessor(std::vector<std::string> endpoints, int connect_timeout_ms, size_t fallback_memory_budget_bytes)
+    : endpoints(endpoints), connect_timeout_ms(connect_timeout_ms), fallback(fallback_memory_budget_bytes) {
+    if (this->endpoints.empty()) {
+        throw std::invalid_argument("ShardedJobQueueProcessor needs at least one worker endpoint");
+    }
+    worker_fds.assign(this->endpoints.size(), -1);
+    readers.reserve(this->endpoints.size());
+    for (size_t i = 0; i < this->endpoints.size(); ++i) {
+        readers.emplace_back(-1);
+    }
+    try {
+        for (size_t i = 0; i < this->endpoints.size(); ++i) {
+            worker_fds[i] = connect_endpoint(this->endpoints[i], connect_timeout_ms);
+            readers[i] = FrameReader(worker_fds[i]);
+        }
+    } catch (...) {
+        for (size_t i = 0; i < worker_fds.size(); ++i) {
+            disconnect(i);
+        }
+        throw;
+    }
+}
+
+ShardedJobQueueProcessor::~ShardedJobQueueProcessor() {
+    for (size_t i = 0; i < worker_fds.size(); ++i) {
+        disconnect(i);
+    }
+}
+
+void ShardedJobQueueProcessor::reconnect() {
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        if (worker_fds[i] < 0) {
+            try {
+                worker_fds[i] = connect_endpoint(endpoints[i], 0);
+                readers[i] = FrameReader(worker_fds[i]);
+            } catch (const std::runtime_error&) {
+                // Still down, its jobs go to the other workers
+            }
+        }
+    }
+}
+
+size_t ShardedJobQueueProcessor::num_connected() const {
+    return static_cast<size_t>(std::count_if(worker_fds.begin(), worker_fds.end(), [](int fd) { return fd >= 0; }));
+}
+
+void ShardedJobQueueProcessor::disconnect(size_t worker) {
+    if (worker_fds[worker] >= 0) {
+        ::close(worker_fds[worker]);
+        worker_fds[worker] = -1;
+        readers[worker] = FrameReader(-1);
+    }
+}
+
+void ShardedJobQueueProcessor::disconnect_pending(std::vector<bool>& pending) {
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (pending[i]) {
+            disconnect(i);
+            pending[i] = false;
+        }
+    }
+}
+
+size_t ShardedJobQueueProcessor::shard_for(const OptionJob& job) const {
+    return shard_hash(job) % endpoints.size();
+}
+
+ShardedJobQueueProcessor::Shards ShardedJobQueueProcessor::shard(const std::vector<const OptionJob*>& jobs) const {
+    std::vector<size_t> connected;
+    for (size_t i = 0; i < worker_fds.size(); ++i) {
+        if (worker_fds[i] >= 0) connected.push_back(i);
+    }
+
+    Shards shards(endpoints.size());
+    for (const OptionJob* job : jobs) {
+        size_t h = shard_hash(*job);
+        size_t worker = h % endpoints.size();
+        if (worker_fds[worker] < 0) {
+            // Same hash over the survivors, so a ticker/expiry still lands on one worker
+            worker = connected[h % connected.size()];
+        }
+        shards[worker].push_back(job);
+    }
+    return shards;
+}
+
+void ShardedJobQueueProcessor::dispatch(const Shards& shards, std::vector<bool>& pending, std::vector<size_t>& lost) {
+    pending.assign(endpoints.size(), false);
+    for (size_t i = 0; i < shards.size(); ++i) {
+        if (shards[i].empty()) continue;
+
+        WireWriter batch;
+        batch.write_u32(static_cast<uint32_t>(shards[i].size()));
+        for (const OptionJob* job : shards[i]) {
+            batch.write_job(*job);
+        }
+        try {
+            send_frame(worker_fds[i], FrameType::JOB_BATCH, batch.data());
+        } catch (const std::runtime_error&) {
+            // The batch may be half sent, so the connection cannot be reused
+            disconnect(i);
+            lost.push_back(i);
+            continue;
+        }
+        pending[i] = true;
+    }
+}
+
+void ShardedJobQueueProcessor::receive(std::vector<bool>& pending, std::vector<OptionJobResult>& results, std::string& errors, std::vector<size_t>& lost) {
+    std::vector<pollfd> fds;
+    std::vector<size_t> workers;
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (pending[i]) {
+            fds.push_back({worker_fds[i], POLLIN, 0});
+            workers.push_back(i);
+        }
+    }
+
+    if (::poll(fds.data(), fds.size(), -1) < 0) {
+        if (errno == EINTR) return;
+        throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+    }
+
+    for (size_t k = 0; k < fds.size(); ++k) {
+        if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+        size_t i = workers[k];
+
+        if (!readers[i].fill()) {
+            disconnect(i);
+            pending[i] = false;
+            lost.push_back(i);
+            continue;
+        }
+
+        FrameType type;
+        std::string payload;
+        while (pending[i] && readers[i].next_frame(type, payload)) {
+            WireReader wire(payload);
+            if (type == FrameType::RESULT) {
+                results.push_back(wire.read_result());
+            } else if (type == FrameType::BATCH_DONE) {
+                pending[i] = false;
+            } else if (type == FrameType::ERROR) {
+                errors += "Worker " + endpoints[i] + ": " + wire.read_string() + ". ";
+                pending[i] = false;
+            }
+        }
+    }
+}
+
+void ShardedJobQueueProcessor::price(const std::vector<OptionJob>& jobs, const std::function<void(std::vector<OptionJobResult>&)>& deliver, std::string& errors) {
+    reconnect();
+
+    std::vector<const OptionJob*> remaining;
+    remaining.reserve(jobs.size());
+    for (const OptionJob& job : jobs) {
+        remaining.push_back(&job);
+    }
+
+    while (!remaining.empty()) {
+        if (num_connected() == 0) {
+            // No worker left: price the rest here rather than drop the batch
+            std::vector<OptionJob> local_jobs;
+            for (const OptionJob* job : remaining) {
+                local_jobs.push_back(*job);
+            }
+            std::mutex results_mutex;
+            std::vector<OptionJobResult> results;
+            fallback.process_jobs(local_jobs, [&results_mutex, &results](const OptionJobResult& result) {
+                std::lock_guard<std::mutex> lock(results_mutex);
+                results.push_back(result);
+            });
+            deliver(results);
+            return;
+        }
+
+        Shards shards = shard(remaining);
+        std::vector<bool> pending(endpoints.size(), false);
+        std::vector<size_t> lost;
+        std::set<ContractKey> received;
+        try {
+            dispatch(shards, pending, lost);
+
+            while (std::find(pending.begin(), pending.end(), true) != pending.end()) {
+                std::vector<OptionJobResult> results;
+                receive(pending, results, errors, lost);
+                for (const OptionJobResult& result : results) {
+                    received.emplace(result.ticker, result.option_type, result.K, result.T);
+                }
+                deliver(results);
+            }
+        } catch (...) {
+            // Frames still due for this batch would be read as the next batch's results
+            disconnect_pending(pending);
+            throw;
+        }
+
+        // Go round again with whatever the lost workers had not priced
+        remaining.clear();
+        for (size_t worker : lost) {
+            for (const OptionJob* job : shards[worker]) {
+                if (!received.count(ContractKey(job->get_ticker(), job->get_option_type(), job->get_K(), job->get_T()))) {
+                    remaining.push_back(job);
+                }
+            }
+        }
+    }
+}
+
+void ShardedJobQueueProcessor::run_batch(JobQueue& queue, std::function<void(OptionJobResult)> callback) {
+    std::vector<OptionJob> jobs = queue.get_all_jobs();
+    if (jobs.empty()) return;
+
+    std::string errors;
+    std::exception_ptr callback_error;
+    {
+        // Hand results to Python as they arrive, releasing the GIL while waiting on workers.
+        // If the callback throws, the rest of the batch is still drained so the connections
+        // stay in step, then the callback's exception is rethrown.
+        py::gil_scoped_release release_gil;
+        price(jobs, [&callback, &callback_error](std::vector<OptionJobResult>& results) {
+            py::gil_scoped_acquire acquire_gil;
+            for (const OptionJobResult& result : results) {
+                if (callback_error) break;
+                try {
+                    callback(result);
+                } catch (...) {
+                    callback_error = std::current_exception();
+                }
+            }
+        }, errors);
+    }
+
+    if (callback_error) {
+        std::rethrow_exception(callback_error);
+    }
+    if (!errors.empty()) {
+        throw std::runtime_error(errors);
+    }
+}
+
+size_t ShardedJobQueueProcessor::run_batch_to_store(JobQueue& queue, ResultStore& store) {
+    std::vector<OptionJob> jobs = queue.get_all_jobs();
+    if (jobs.empty()) return 0;
+
+    size_t written = 0;
+    std::string errors;
+    {
+        py::gil_scoped_release release_gil;
+        uint64_t generation = store.begin_batch();
+        price(jobs, [&store, &written](std::vector<OptionJobResult>& results) {
+            for (const OptionJobResult& result : results) {
+                if (store.write(result)) ++written;
+            }
+        }, errors);
+        // A worker that rejected its shard did not rewrite those contracts; keep them
+        if (errors.empty()) {
+            store.reclaim_stale(generation, batch_tickers(jobs));
+        }
+    }
+
+    if (!errors.empty()) {
+        throw std::runtime_error(errors);
+    }
+    return written;
+}
+
+void ShardedJobQueueProcessor::shutdown_workers() {
+    for (size_t i = 0; i < worker_fds.size(); ++i) {
+        if (worker_fds[i] >= 0) {
+            try {
+                send_frame(worker_fds[i], FrameType::SHUTDOWN, std::string());
+            } catch (const std::runtime_error&) {
+                // Worker already gone
+            }
+            disconnect(i);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "../job_queue.h"
+#include "protocol.h"
+
+class ResultStore;
+
+// Pricing worker process: accepts a coordinator connection, prices each
+// JOB_BATCH on a local JobQueueProcessor and streams RESULT frames back
+class PricingWorker {
+public:
+    // num_threads 0 uses every hardware thread; local workers sharing a machine should split it
+    explicit PricingWorker(std::string endpoint, size_t memory_budget_bytes = DEFAULT_MEMORY_BUDGET_BYTES, size_t num_threads = 0);
+    ~PricingWorker();
+
+    PricingWorker(const PricingWorker&) = delete;
+    PricingWorker& operator=(const PricingWorker&) = delete;
+
+    // Serve coordinator connections until a SHUTDOWN frame arrives
+    void serve();
+
+    inline const std::string& get_endpoint() const { return endpoint; }
+
+private:
+    std::string endpoint;
+    JobQueueProcessor processor;
+    int listen_fd;
+
+    // Returns true if the coordinator asked the worker to shut down
+    bool handle_connection(int connection_fd);
+};
+
+// Coordinator that shards a JobQueue by ticker/expiry across pricing workers
+// and streams their results into the same callback interface as JobQueueProcessor.
+// Jobs of a worker that is lost mid-batch are re-sharded over the remaining
+// workers; once none is reachable, batches are priced in this process.
+class ShardedJobQueueProcessor {
+public:
+    // Every worker must be reachable within connect_timeout_ms. fallback_memory_budget_bytes
+    // caps pricing in this process while no worker is reachable.
+    explicit ShardedJobQueueProcessor(std::vector<std::string> endpoints, int connect_timeout_ms = 5000,
+                                      size_t fallback_memory_budget_bytes = DEFAULT_MEMORY_BUDGET_BYTES);
+    ~ShardedJobQueueProcessor();
+
+    ShardedJobQueueProcessor(const ShardedJobQueueProcessor&) = delete;
+    ShardedJobQueueProcessor& operator=(const ShardedJobQueueProcessor&) = delete;
+
+    void run_batch(JobQueue& queue, std::function<void(OptionJobResult)> callback);
+    size_t run_batch_to_store(JobQueue& queue, ResultStore& store);
+
+    // Ask every worker to exit and drop the connections
+    void shutdown_workers();
+
+    // All contracts of one ticker and expiry land on the same worker while it is connected
+    size_t shard_for(const OptionJob& job) const;
+
+    inline size_t num_workers() const { return endpoints.size(); }
+    size_t num_connected() const;
+    inline const std::vector<std::string>& get_endpoints() const { return endpoints; }
+
+private:
+    std::vector<std::string> endpoints;
+    std::vector<int> worker_fds;
+    std::vector<FrameReader> readers;
+    const int connect_timeout_ms;
+    JobQueueProcessor fallback;
+
+    using Shards = std::vector<std::vector<const OptionJob*>>;
+
+    // Try once to reconnect workers whose connection was dropped; unreachable ones sit out the batch
+    void reconnect();
+    void disconnect(size_t worker);
+
+    // Drop every worker that still owes frames for the current batch, so a failed
+    // batch cannot leak results into the next one
+    void disconnect_pending(std::vector<bool>& pending);
+
+    // Price jobs on the connected workers, handing results to deliver as they arrive.
+    // Jobs a lost worker did not finish are re-sharded over the workers still connected,
+    // or priced in this process once none is. Worker ERROR frames are recorded in errors.
+    void price(const std::vector<OptionJob>& jobs, const std::function<void(std::vector<OptionJobResult>&)>& deliver, std::string& errors);
+
+    // Group jobs by worker: each job's shard_for worker if connected, else one of the connected ones
+    Shards shard(const std::vector<const OptionJob*>& jobs) const;
+
+    // Send each worker its shard, marking in pending which workers have a batch in flight.
+    // A worker whose send fails is disconnected and added to lost.
+    void dispatch(const Shards& shards, std::vector<bool>& pending, std::vector<size_t>& lost);
+
+    // Block until at least one frame arrives, appending results; clears pending on BATCH_DONE.
+    // A worker whose connection drops is added to lost, a worker ERROR is recorded in errors,
+    // so the other streams stay in sync.
+    void receive(std::vector<bool>& pending, std::vector<OptionJobResult>& results, std::string& errors, std::vector<size_t>& lost);
+};
+
+#endif // WORKER_POOL_H
@@ -1,7 +1,7 @@
 import yfinance as yf
 import time
 import pandas as pd
-from typing import List, Dict, Any
+from typing import List, Dict, Any, Union
 import option_solver_cpp
 from market_data.calculate_annual_volatility import calculate_annual_volatility
 from market_data.calculate_risk_free_rate import calculate_risk_free_rate
@@ -90,12 +90,16 @@ def poll_options_data(tickers: List[str], time_interval: int = 30) -> Dict[str,
     
     return results
 
-def create_option_jobs(options_data: Dict[str, List[Dict[str, Any]]]) -> List[option_solver_cpp.OptionJob]:
+def create_option_jobs(
+    options_data: Dict[str, List[Dict[str, Any]]],
+    precision: option_solver_cpp.Precision = option_solver_cpp.Precision.DOUBLE
+) -> List[option_solver_cpp.OptionJob]:
     """
     Convert polled options data into OptionJob objects
     
     Args:
         options_data: Dictionary mapping ticker -> list of options
+        precision: Solver precision for every job (FLOAT re-solves in DOUBLE if inaccurate)
         
     Returns:
         List of OptionJob objects ready for processing
@@ -137,7 +141,8 @@ def create_option_jobs(options_data: Dict[str, List[Dict[str, Any]]]) -> List[op
                     current_option_price=opt['option_price'],
                     r=r,
                     sigma=sigma,
-                    q=q
+                    q=q,
+                    precision=precision
                 )
                 jobs.append(job)
                 
@@ -151,9 +156,13 @@ def continuous_poll_and_process(
     tickers: List[str], 
     callback_function, 
     stop_event, 
-    processor: option_solver_cpp.JobQueueProcessor, 
+    processor: Union[option_solver_cpp.JobQueueProcessor, option_solver_cpp.ShardedJobQueueProcessor], 
     job_queue: option_solver_cpp.JobQueue,
-    time_interval: int = 30
+    time_interval: int = 30,
+    result_store: option_solver_cpp.ResultStore = None,
+    publish_function = None,
+    progressive_tolerance: float = None,
+    precision: option_solver_cpp.Precision = option_solver_cpp.Precision.DOUBLE
 ):
     """
     Continuously poll options data and process jobs with C++ JobQueueProcessor
@@ -162,24 +171,44 @@ def continuous_poll_and_process(
         tickers: List of ticker symbols
         callback_function: Function to call with each OptionJobResult
         stop_event: threading.Event to signal stopping
-        processor: The JobQueueProcessor instance
+        processor: The JobQueueProcessor or ShardedJobQueueProcessor instance
         job_queue: The JobQueue instance
         time_interval: Polling interval in seconds (default 30)
+        result_store: Optional ResultStore that workers write into directly instead of the callback
+        publish_function: Called once per batch with (result_store, tickers) when result_store is set
+        progressive_tolerance: If set, publish provisional coarse prices first and refine them (callback path only)
+        precision: Solver precision for the created jobs
     """
     while not stop_event.is_set():
-        # Poll options data
-        options_data = poll_options_data(tickers)
-        
-        # Convert to OptionJob objects and add to queue
-        jobs = create_option_jobs(options_data)
-        
-        for job in jobs:
-            job_queue.add_or_replace_job(job)
-        
-        if job_queue.size() > 0:  # Only process if we have jobs
-            print(f"Processing {job_queue.size()} jobs...")
-            # Process jobs in parallel and stream results via callback
-            processor.run_batch(job_queue, callback_function)
-        
+        try:
+            # Poll options data
+            options_data = poll_options_data(tickers)
+
+            # Convert to OptionJob objects and add to queue
+            jobs = create_option_jobs(options_data, precision)
+
+            for job in jobs:
+                job_queue.add_or_replace_job(job)
+
+            if job_queue.size() > 0:  # Only process if we have jobs
+                print(f"Processing {job_queue.size()} jobs...")
+                if result_store is not None:
+                    # Workers write into shared memory; publish downstream once per batch
+                    job_count = job_queue.size()
+                    written = processor.run_batch_to_store(job_queue, result_store)
+                    if written < job_count:
+                        print(f"Warning: Result store kept {written} of {job_count} results (capacity {result_store.capacity}).")
+                    if publish_function is not None:
+                        publish_function(result_store, tickers)
+                elif progressive_tolerance is not None:
+                    # Provisional coarse prices first, refined prices replace them as workers free up
+                    processor.run_batch_progressive(job_queue, callback_function, progressive_tolerance)
+                else:
+                    # Process jobs in parallel and stream results via callback
+                    processor.run_batch(job_queue, callback_function)
+        except Exception as e:
+            # A failed batch must not end the polling thread; the next interval retries
+            print(f"Error: Batch processing failed, retrying next interval. Error: {e}")
+
         # Wait for the next interval, but check stop_event periodically
         stop_event.wait(time_interval)
\ No newline at end of file
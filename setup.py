@@ -11,7 +11,7 @@ cpp_args = [
 ext_modules = [
     Extension(
         'option_solver_cpp',
-        ['cpp/bindings.cpp', 'cpp/job_queue.cpp', 'cpp/models/option.cpp', 'cpp/solvers/crank_nicolson.cpp', 'cpp/solvers/mesh.cpp'],
+        ['cpp/bindings.cpp', 'cpp/job_queue.cpp', 'cpp/result_store.cpp', 'cpp/models/option.cpp', 'cpp/solvers/crank_nicolson.cpp', 'cpp/solvers/mesh.cpp', 'cpp/workers/protocol.cpp', 'cpp/workers/worker_pool.cpp'],
         include_dirs=[
             pybind11.get_include(),
             'cpp'
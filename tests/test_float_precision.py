@@ -0,0 +1,73 @@
+import math
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+option_solver_cpp = pytest.importorskip("option_solver_cpp")
+
+Precision = option_solver_cpp.Precision
+SolverMode = option_solver_cpp.SolverMode
+Processor = option_solver_cpp.JobQueueProcessor
+ACCEPT_BELOW = option_solver_cpp.FLOAT_PRICE_TOLERANCE / option_solver_cpp.FLOAT_ERROR_SAFETY_FACTOR
+
+def make_job(option_type, K, T, precision, sigma=0.3):
+    return option_solver_cpp.OptionJob(
+        ticker='AAPL', option_type=option_type, K=K, T=T,
+        current_price=103.21, current_option_price=1.0, r=0.05, sigma=sigma, precision=precision
+    )
+
+def batch_price(job):
+    queue = option_solver_cpp.JobQueue()
+    queue.add_or_replace_job(job)
+    results = []
+    Processor().run_batch(queue, results.append)
+    assert len(results) == 1
+    return results[0].fair_value
+
+@pytest.mark.parametrize("option_type,K,T", [
+    ('american_put', 100, 14 / 365),
+    ('european_put', 100, 7 / 365),
+])
+def test_short_dated_float_is_accepted(option_type, K, T):
+    float_job = make_job(option_type, K, T, Precision.FLOAT)
+    assert Processor.float_rounding_floor(float_job) <= Processor.float_error_estimate(float_job) <= ACCEPT_BELOW
+
+    float_price = Processor.solve_job(float_job, SolverMode.ROLLING)
+    double_price = Processor.solve_job(make_job(option_type, K, T, Precision.DOUBLE), SolverMode.ROLLING)
+    assert batch_price(float_job) == float_price
+    assert float_price == pytest.approx(double_price, abs=0.01)
+
+@pytest.mark.parametrize("option_type,K,T", [
+    ('american_call', 100, 1.0),
+    ('american_put', 100, 2.0),
+])
+def test_long_dated_float_is_not_attempted(option_type, K, T):
+    float_job = make_job(option_type, K, T, Precision.FLOAT)
+    assert Processor.float_rounding_floor(float_job) > ACCEPT_BELOW
+
+    double_price = Processor.solve_job(make_job(option_type, K, T, Precision.DOUBLE), SolverMode.ROLLING)
+    assert batch_price(float_job) == double_price
+
+def test_float_failing_the_estimate_falls_back_to_double():
+    float_job = make_job('american_put', 105, 30 / 365, Precision.FLOAT)
+    assert Processor.float_rounding_floor(float_job) <= ACCEPT_BELOW < Processor.float_error_estimate(float_job)
+
+    double_price = Processor.solve_job(make_job('american_put', 105, 30 / 365, Precision.DOUBLE), SolverMode.ROLLING)
+    assert batch_price(float_job) == double_price
+
+@pytest.mark.parametrize("precision", [Precision.DOUBLE, Precision.FLOAT])
+@pytest.mark.parametrize("option_type", ['european_call', 'american_put'])
+def test_rolling_matches_full_grid_at_both_precisions(option_type, precision):
+    job = make_job(option_type, 100, 0.05, precision)
+    assert Processor.solve_job(job, SolverMode.ROLLING) == Processor.solve_job(job, SolverMode.FULL_GRID)
+
+@pytest.mark.parametrize("option_type", ['european_call', 'american_put'])
+def test_error_estimate_is_the_same_on_both_layouts(option_type):
+    job = make_job(option_type, 100, 0.05, Precision.FLOAT)
+    assert Processor.float_error_estimate(job, SolverMode.ROLLING) == Processor.float_error_estimate(job, SolverMode.FULL_GRID)
+
+def test_non_finite_float_solve_is_rejected():
+    job = make_job('american_put', 100, 0.05, Precision.FLOAT, sigma=math.nan)
+    assert Processor.float_error_estimate(job) == sys.float_info.max
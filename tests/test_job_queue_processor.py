@@ -0,0 +1,88 @@
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+option_solver_cpp = pytest.importorskip("option_solver_cpp")
+
+def make_job(option_type, K=100, T=0.1, current_price=103.21, precision=None):
+    kwargs = {} if precision is None else {'precision': precision}
+    return option_solver_cpp.OptionJob(
+        ticker='AAPL', option_type=option_type, K=K, T=T,
+        current_price=current_price, current_option_price=1.0, r=0.05, sigma=0.3, **kwargs
+    )
+
+def key(result):
+    return (result.ticker, result.option_type, result.K, result.T)
+
+@pytest.mark.parametrize("option_type", ['european_call', 'european_put', 'american_call', 'american_put'])
+def test_rolling_matches_full_grid(option_type):
+    job = make_job(option_type)
+    full = option_solver_cpp.JobQueueProcessor.solve_job(job, option_solver_cpp.SolverMode.FULL_GRID)
+    rolling = option_solver_cpp.JobQueueProcessor.solve_job(job, option_solver_cpp.SolverMode.ROLLING)
+    assert rolling == full
+
+def test_rolling_working_set_is_smaller():
+    job = make_job('american_call')
+    full = option_solver_cpp.JobQueueProcessor.estimate_job_bytes(job, option_solver_cpp.SolverMode.FULL_GRID)
+    rolling = option_solver_cpp.JobQueueProcessor.estimate_job_bytes(job)
+    assert rolling * 10 < full
+
+def test_over_budget_jobs_are_still_admitted():
+    def run(processor):
+        queue = option_solver_cpp.JobQueue()
+        for i in range(8):
+            queue.add_or_replace_job(make_job('american_call' if i % 2 == 0 else 'american_put', K=90 + 3 * i, T=0.05))
+        results = {}
+        processor.run_batch(queue, lambda r: results.__setitem__(key(r), r.fair_value))
+        return results
+
+    # Every job is larger than a 1 byte budget, so they run one at a time
+    tight = run(option_solver_cpp.JobQueueProcessor(memory_budget_bytes=1))
+    default = run(option_solver_cpp.JobQueueProcessor())
+
+    assert len(tight) == 8
+    assert tight == default
+
+def make_progressive_queue():
+    queue = option_solver_cpp.JobQueue()
+    for i in range(8):
+        queue.add_or_replace_job(make_job('american_call' if i % 2 == 0 else 'american_put', K=90 + 3 * i, T=0.05 + 0.02 * (i % 3)))
+    return queue
+
+@pytest.mark.parametrize("tolerance", [0.01, 0.0])
+def test_progressive_publishes_one_provisional_then_one_final(tolerance):
+    # tolerance 0 sends every job down the full-resolution fallback
+    updates = {}
+    option_solver_cpp.JobQueueProcessor().run_batch_progressive(
+        make_progressive_queue(), lambda r: updates.setdefault(key(r), []).append(r.provisional), tolerance
+    )
+    assert len(updates) == 8
+    assert all(flags == [True, False] for flags in updates.values())
+
+def test_progressive_final_prices_use_one_estimator():
+    def final_prices(tolerance):
+        prices = {}
+        option_solver_cpp.JobQueueProcessor().run_batch_progressive(
+            make_progressive_queue(), lambda r: None if r.provisional else prices.__setitem__(key(r), r.fair_value), tolerance
+        )
+        return prices
+
+    extrapolated = final_prices(1e9)
+    full_resolution = final_prices(0.0)
+    for k, value in extrapolated.items():
+        assert full_resolution[k] == pytest.approx(value, abs=1e-3)
+
+def test_progressive_callback_error_propagates():
+    def failing_callback(result):
+        raise RuntimeError('cache unavailable')
+
+    processor = option_solver_cpp.JobQueueProcessor()
+    with pytest.raises(RuntimeError, match='cache unavailable'):
+        processor.run_batch_progressive(make_progressive_queue(), failing_callback)
+
+    # The processor is still usable afterwards
+    results = []
+    processor.run_batch_progressive(make_progressive_queue(), results.append)
+    assert len(results) == 16
@@ -0,0 +1,143 @@
+import multiprocessing
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+option_solver_cpp = pytest.importorskip("option_solver_cpp")
+
+def make_result(ticker, K, T=0.5, fair_value=1.0):
+    # current_price and current_option_price track fair_value so torn reads are detectable
+    return option_solver_cpp.OptionJobResult(ticker, 'american_call', K, T, fair_value, fair_value, fair_value)
+
+@pytest.fixture
+def store_path(tmp_path):
+    return str(tmp_path / 'results.bin')
+
+def test_write_read_and_overwrite(store_path):
+    store = option_solver_cpp.ResultStore(store_path, 16)
+    assert store.write(make_result('AAPL', 100, fair_value=1.0))
+    assert store.write(make_result('AAPL', 105, fair_value=2.0))
+    assert store.write(make_result('AAPL', 100, fair_value=3.0))
+
+    results = {r.K: r.fair_value for r in store.read_ticker('AAPL')}
+    assert results == {100: 3.0, 105: 2.0}
+    assert store.size() == 2
+
+def test_remove_ticker_frees_slots(store_path):
+    store = option_solver_cpp.ResultStore(store_path, 4)
+    for K in (100, 105, 110):
+        assert store.write(make_result('AAPL', K))
+    assert store.write(make_result('MSFT', 300))
+
+    store.remove_ticker('AAPL')
+    assert store.read_ticker('AAPL') == []
+    assert [r.ticker for r in store.read_all()] == ['MSFT']
+
+    # Removed slots are reused
+    for K in (200, 205, 210):
+        assert store.write(make_result('GOOG', K))
+    assert store.size() == 4
+
+def test_reopen_existing_file(store_path):
+    store = option_solver_cpp.ResultStore(store_path, 8)
+    store.write(make_result('AAPL', 100, fair_value=4.5))
+    del store
+
+    reopened = option_solver_cpp.ResultStore(store_path)
+    assert reopened.capacity == 8
+    assert [r.fair_value for r in reopened.read_ticker('AAPL')] == [4.5]
+
+def test_full_store_rejects_new_contracts(store_path):
+    store = option_solver_cpp.ResultStore(store_path, 2)
+    assert store.write(make_result('AAPL', 100))
+    assert store.write(make_result('AAPL', 105))
+    assert not store.write(make_result('AAPL', 110))
+    # Existing contracts can still be updated
+    assert store.write(make_result('AAPL', 105, fair_value=9.0))
+    assert sorted(r.fair_value for r in store.read_ticker('AAPL')) == [1.0, 9.0]
+
+def test_batches_reclaim_contracts_that_rolled_over(store_path):
+    store = option_solver_cpp.ResultStore(store_path, 4)
+    for day in range(6):
+        # T is recomputed from whole days, so every contract gets a new key each day
+        generation = store.begin_batch()
+        T = 0.5 - day / 365
+        assert store.write(make_result('AAPL', 100, T=T, fair_value=day))
+        assert store.write(make_result('AAPL', 105, T=T, fair_value=day))
+        store.reclaim_stale(generation)
+
+        assert sorted((r.K, r.T) for r in store.read_ticker('AAPL')) == [(100, T), (105, T)]
+
+def make_job(ticker, K, T=0.1):
+    return option_solver_cpp.OptionJob(
+        ticker=ticker, option_type='american_call', K=K, T=T,
+        current_price=100.0, current_option_price=1.0, r=0.05, sigma=0.3
+    )
+
+def run_batch_to_store(store, jobs):
+    queue = option_solver_cpp.JobQueue()
+    for job in jobs:
+        queue.add_or_replace_job(job)
+    return option_solver_cpp.JobQueueProcessor().run_batch_to_store(queue, store)
+
+def test_batch_only_reclaims_tickers_it_priced(store_path):
+    store = option_solver_cpp.ResultStore(store_path, 16)
+    assert run_batch_to_store(store, [make_job('AAPL', 100), make_job('AAPL', 105), make_job('MSFT', 300)]) == 3
+
+    # AAPL's fetch failed this time, MSFT's contract rolled to a new T
+    T = 0.1 - 1 / 365
+    assert run_batch_to_store(store, [make_job('MSFT', 300, T=T)]) == 1
+
+    assert sorted(r.K for r in store.read_ticker('AAPL')) == [100, 105]
+    assert [(r.K, r.T) for r in store.read_ticker('MSFT')] == [(300, T)]
+
+def insert_contracts(path, count):
+    store = option_solver_cpp.ResultStore(path)
+    for K in range(count):
+        assert store.write(make_result('AAPL', K))
+
+def remove_contracts(path, ticker):
+    option_solver_cpp.ResultStore(path).remove_ticker(ticker)
+
+def test_concurrent_inserts_of_one_key_take_one_slot(store_path):
+    store = option_solver_cpp.ResultStore(store_path, 256)
+    for K in range(100):
+        store.write(make_result('OLD', K))
+
+    # Slots freed while the writers probe give each of them a different candidate slot
+    count = 100
+    context = multiprocessing.get_context('fork')
+    processes = [context.Process(target=remove_contracts, args=(store_path, 'OLD'))]
+    processes += [context.Process(target=insert_contracts, args=(store_path, count)) for _ in range(4)]
+    for process in processes:
+        process.start()
+    for process in processes:
+        process.join()
+        assert process.exitcode == 0
+
+    assert store.size() == count
+    assert sorted(r.K for r in store.read_ticker('AAPL')) == list(range(count))
+
+def write_updates(path, count):
+    store = option_solver_cpp.ResultStore(path)
+    for i in range(1, count + 1):
+        store.write(make_result('AAPL', 100, fair_value=float(i)))
+
+def test_reader_in_another_process_sees_consistent_values(store_path):
+    store = option_solver_cpp.ResultStore(store_path, 16)
+    store.write(make_result('AAPL', 100, fair_value=0.0))
+
+    count = 100000
+    writer = multiprocessing.get_context('fork').Process(target=write_updates, args=(store_path, count))
+    writer.start()
+    last = 0.0
+    while writer.is_alive():
+        for r in store.read_ticker('AAPL'):
+            assert r.current_price == r.current_option_price == r.fair_value
+            assert r.fair_value >= last
+            last = r.fair_value
+    writer.join()
+    assert writer.exitcode == 0
+    assert [r.fair_value for r in store.read_ticker('AAPL')] == [float(count)]
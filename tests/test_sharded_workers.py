@@ -0,0 +1,138 @@
+import multiprocessing
+import os
+import sys
+import pytest
+
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+option_solver_cpp = pytest.importorskip("option_solver_cpp")
+from api.pricing_workers import spawn_local_workers, stop_local_workers
+
+def make_queue():
+    queue = option_solver_cpp.JobQueue()
+    for i, (ticker, T) in enumerate([('AAPL', 0.05), ('AAPL', 0.1), ('MSFT', 0.05), ('GOOG', 0.08)] * 3):
+        option_type = 'american_call' if i % 2 == 0 else 'american_put'
+        queue.add_or_replace_job(option_solver_cpp.OptionJob(
+            ticker=ticker, option_type=option_type, K=90 + 2 * i, T=T,
+            current_price=100, current_option_price=1.0, r=0.05, sigma=0.3
+        ))
+    return queue
+
+def key(result):
+    return (result.ticker, result.option_type, result.K, result.T)
+
+@pytest.fixture
+def local_workers(tmp_path):
+    processes, endpoints = spawn_local_workers(2, socket_dir=str(tmp_path), memory_budget_mb=256)
+    coordinator = option_solver_cpp.ShardedJobQueueProcessor(endpoints)
+    yield processes, coordinator
+    stop_local_workers(processes, coordinator)
+
+@pytest.fixture
+def workers(local_workers):
+    return local_workers[1]
+
+def test_sharded_matches_in_process(workers):
+    local = {}
+    option_solver_cpp.JobQueueProcessor().run_batch(make_queue(), lambda r: local.__setitem__(key(r), r.fair_value))
+
+    sharded = {}
+    workers.run_batch(make_queue(), lambda r: sharded.__setitem__(key(r), r.fair_value))
+
+    assert sharded.keys() == local.keys()
+    for k, value in local.items():
+        assert sharded[k] == pytest.approx(value, rel=1e-12)
+
+def test_same_ticker_and_expiry_share_a_shard(workers):
+    a = option_solver_cpp.OptionJob('AAPL', 'american_call', 100, 0.1, 100, 1.0, 0.05, 0.3)
+    b = option_solver_cpp.OptionJob('AAPL', 'american_put', 120, 0.1, 100, 1.0, 0.05, 0.3)
+    assert workers.shard_for(a) == workers.shard_for(b)
+
+def test_workers_survive_multiple_batches(workers):
+    for _ in range(2):
+        results = []
+        workers.run_batch(make_queue(), results.append)
+        assert len(results) == 12
+
+def test_failed_callback_does_not_leak_into_next_batch(workers):
+    def failing_callback(result):
+        raise RuntimeError('cache unavailable')
+
+    with pytest.raises(RuntimeError, match='cache unavailable'):
+        workers.run_batch(make_queue(), failing_callback)
+
+    queue = option_solver_cpp.JobQueue()
+    queue.add_or_replace_job(option_solver_cpp.OptionJob('AAPL', 'american_put', 95, 0.05, 100, 1.0, 0.05, 0.3))
+    results = []
+    workers.run_batch(queue, results.append)
+    assert [(r.option_type, r.K) for r in results] == [('american_put', 95)]
+
+def in_process_prices():
+    prices = {}
+    option_solver_cpp.JobQueueProcessor().run_batch(make_queue(), lambda r: prices.__setitem__(key(r), r.fair_value))
+    return prices
+
+def test_jobs_of_a_worker_killed_mid_batch_move_to_the_other(local_workers):
+    processes, coordinator = local_workers
+    prices = {}
+    killed = []
+    def kill_on_first_result(result):
+        if not killed:
+            # Kill the worker that priced this result, so the lost worker had a shard
+            job = option_solver_cpp.OptionJob(result.ticker, result.option_type, result.K, result.T, 100, 1.0, 0.05, 0.3)
+            killed.append(processes[coordinator.shard_for(job)])
+            killed[0].kill()
+            killed[0].wait()
+        prices.setdefault(key(result), []).append(result.fair_value)
+
+    coordinator.run_batch(make_queue(), kill_on_first_result)
+    assert prices.keys() == in_process_prices().keys()
+    assert all(len(values) == 1 for values in prices.values())
+
+    # Later batches run on the surviving worker
+    results = []
+    coordinator.run_batch(make_queue(), results.append)
+    assert len(results) == 12
+    assert coordinator.num_connected() == 1
+    assert all(process.poll() is None for process in processes if process is not killed[0])
+
+def test_batch_is_priced_in_process_when_every_worker_is_gone(local_workers):
+    processes, coordinator = local_workers
+    for process in processes:
+        process.kill()
+        process.wait()
+
+    sharded = {}
+    coordinator.run_batch(make_queue(), lambda r: sharded.__setitem__(key(r), r.fair_value))
+    assert coordinator.num_connected() == 0
+    assert sharded == in_process_prices()
+
+def abandon_batch(endpoints):
+    coordinator = option_solver_cpp.ShardedJobQueueProcessor(endpoints)
+    coordinator.run_batch(make_queue(), lambda result: os._exit(0))
+
+def test_workers_outlive_a_coordinator_that_dies_mid_batch(tmp_path):
+    processes, endpoints = spawn_local_workers(2, socket_dir=str(tmp_path), memory_budget_mb=256)
+    coordinator = None
+    try:
+        # The workers' remaining RESULT and BATCH_DONE frames go to a closed socket
+        abandoned = multiprocessing.get_context('fork').Process(target=abandon_batch, args=(endpoints,))
+        abandoned.start()
+        abandoned.join()
+
+        coordinator = option_solver_cpp.ShardedJobQueueProcessor(endpoints)
+        results = []
+        coordinator.run_batch(make_queue(), results.append)
+        assert len(results) == 12
+        assert coordinator.num_connected() == 2
+        assert all(process.poll() is None for process in processes)
+    finally:
+        stop_local_workers(processes, coordinator)
+
+def test_local_workers_split_budget_and_threads(tmp_path):
+    processes, endpoints = spawn_local_workers(2, socket_dir=str(tmp_path), memory_budget_mb=256, num_threads=4)
+    try:
+        for process in processes:
+            assert process.args[-4:] == ['--memory-budget-mb', '128', '--threads', '2']
+    finally:
+        stop_local_workers(processes, option_solver_cpp.ShardedJobQueueProcessor(endpoints))